@@ -4,10 +4,13 @@ set -eu
 
 ROOT=$(realpath $(dirname $0))
 DATASET_DIR=$(realpath $ROOT/test)
-DATASETS="$(find $DATASET_DIR -type f -name *.graph)"
 BENCHMARK=""
 ENABLE_THREADED=0
+WARMUP=1
 REPETITIONS=5
+JSON_DIR=""
+SYNTHETIC_ARCS=0
+SYNTHETIC_MODELS="RMAT COPYING ERDOS_RENYI CONFIGURATION"
 
 while (( "$#" )); do
     case "$1" in
@@ -15,6 +18,15 @@ while (( "$#" )); do
             ENABLE_THREADED=1
             shift
             ;;
+        --json-dir)
+            JSON_DIR=$(realpath $2)
+            mkdir -p $JSON_DIR
+            shift 2
+            ;;
+        --synthetic)
+            SYNTHETIC_ARCS=$2
+            shift 2
+            ;;
         -*)
             echo "Error: Unknown flag $1"
             exit 1
@@ -36,30 +48,51 @@ if [ -z "$BENCHMARK" ]; then
     exit 1
 fi
 
+# Instead of the graphs in test/, generate a graph of every model with the given number of arcs and
+# 16 arcs per node, which the benchmark generates the same on every machine
+if [ "$SYNTHETIC_ARCS" -gt 0 ]; then
+    DATASET_DIR=$(mktemp -d)
+    trap "rm -r $DATASET_DIR" EXIT
+    for MODEL in $SYNTHETIC_MODELS; do
+        $BENCHMARK --warmup 0 --repetitions 1 generate --model $MODEL --nodes $(( SYNTHETIC_ARCS / 16 + 1 )) \
+            --arcs $SYNTHETIC_ARCS $DATASET_DIR/${MODEL,,}-$SYNTHETIC_ARCS > /dev/null 2>&1
+    done
+fi
+
+DATASETS="$(find $DATASET_DIR -type f -name *.graph)"
+
+# The benchmark repeats every test itself, and prints the median runtime
 function run_tests() {
     for F in $DATASETS; do
         GRAPH="$(basename $F .graph)"
         GRAPH_PATH="$(dirname $F)/$GRAPH"
-        RUNTIMES=""
-        for I in $(seq $REPETITIONS); do
-            $1 $GRAPH_PATH
-            RUNTIMES="$RUNTIMES $RUNTIME"
-        done
-        echo $GRAPH $RUNTIMES
+        $1 $GRAPH_PATH $GRAPH
+        echo $GRAPH $RUNTIME
     done
 }
 
+function harness_options() {
+    echo "--warmup $WARMUP --repetitions $REPETITIONS"
+    if [ -n "$JSON_DIR" ]; then
+        echo "--json $JSON_DIR/$1.$2.json"
+    fi
+}
+
 function run_decode_test() {
-    RUNTIME=$($BENCHMARK decode $1)
+    RUNTIME=$($BENCHMARK $(harness_options $2 decode) decode $1)
+}
+
+function run_triangle_test() {
+    RUNTIME=$($BENCHMARK $(harness_options $2 triangles) triangles $1)
 }
 
 function run_encode_test() {
-    RUNTIME=$($BENCHMARK encode $1 $1.out)
+    RUNTIME=$($BENCHMARK $(harness_options $2 encode) encode $1 $1.out)
     rm $1.out.*
 }
 
 function run_encode_test_threaded() {
-    RUNTIME=$($BENCHMARK encode --threads 16 $1 $1.out)
+    RUNTIME=$($BENCHMARK $(harness_options $2 encode-threaded) encode --threads 16 $1 $1.out)
     rm $1.out.*
 }
 
@@ -69,6 +102,9 @@ run_tests run_decode_test
 echo "Running encode tests"
 run_tests run_encode_test
 
+echo "Running triangle counting tests"
+run_tests run_triangle_test
+
 if [ "$ENABLE_THREADED" == "1" ]; then
     echo "Running threaded encode tests"
     run_tests run_encode_test_threaded
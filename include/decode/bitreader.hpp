@@ -2,7 +2,9 @@
 #define _JORMUNGANDR_DECODE_BITREADER_HPP
 
 #include <iosfwd>
+#include <ios>
 #include <optional>
+#include <functional>
 #include <bit>
 #include <cstdint>
 #include <vector>
@@ -17,6 +19,11 @@ class BitReader {
         uint64_t buffer[buffer_size];
         size_t offset;
         size_t buffer_bytes_left;
+        // Position in the input of the first byte in the buffer
+        uint64_t buffer_start;
+        // Position in the stream at which reading started, or -1 if it cannot be sought
+        std::streamoff input_start;
+        std::function<void()> progress_callback;
 
         struct BitBuf {
             uint64_t value;
@@ -33,6 +40,15 @@ class BitReader {
         BitReader& operator=(BitReader&&) = delete;
 
         auto at_end() const -> bool;
+        // Number of bits read so far
+        auto bit_position() const -> uint64_t;
+
+        // Skip to the next byte boundary
+        auto align() -> void;
+        // Seek back to where reading started
+        auto rewind() -> void;
+        // Call callback after every refill of the buffer, such as to report progress
+        auto on_progress(std::function<void()> callback) -> void;
 
         auto peek_bit() -> std::optional<uint8_t>;
         auto read_bit() -> uint8_t;
@@ -46,6 +62,7 @@ class BitReader {
         auto read_minimal_binary(uint64_t z) -> uint64_t;
         auto read_zeta(uint64_t k) -> uint64_t;
         auto read_golomb(uint64_t b) -> uint64_t;
+        auto read_nibble() -> uint64_t;
         auto read_pred_size(uint64_t size) -> uint64_t;
 
     private:
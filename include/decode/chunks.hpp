@@ -0,0 +1,20 @@
+#ifndef _JORMUNGANDR_DECODE_CHUNKS_HPP
+#define _JORMUNGANDR_DECODE_CHUNKS_HPP
+
+#include <iosfwd>
+#include <vector>
+
+#include "encoding.hpp"
+
+// Reads the index written by ChunkIndexEncoder
+class ChunkIndexDecoder {
+    private:
+        std::istream& input;
+    public:
+        ChunkIndexDecoder(std::istream&);
+        ~ChunkIndexDecoder() = default;
+
+        auto decode() -> std::vector<ChunkEntry>;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <iosfwd>
 #include <concepts>
+#include <span>
 
 #include "graph/graph.hpp"
 
@@ -12,4 +13,12 @@ concept Decoder = requires(T t) {
     { t.decode() } -> std::convertible_to<Graph<U>>;
 };
 
+// Anything producing successor lists in node order, such as WebGraphDecoder
+template <typename T, typename U>
+concept NodeStream = requires(T t) {
+    requires std::unsigned_integral<U>;
+    { t.next_node()->index } -> std::convertible_to<U>;
+    { t.next_node()->neighbours } -> std::convertible_to<std::span<const U>>;
+};
+
 #endif
@@ -0,0 +1,46 @@
+#ifndef _JORMUNGANDR_DECODE_ELIASFANO_HPP
+#define _JORMUNGANDR_DECODE_ELIASFANO_HPP
+
+#include "decode/property.hpp"
+#include "graph/eliasfano.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+#include <vector>
+#include <bit>
+
+// Reads a graph written by EliasFanoEncoder
+template <std::unsigned_integral T>
+class EliasFanoDecoder {
+    private:
+        std::istream& input;
+        PropertyMap properties;
+
+    public:
+        EliasFanoDecoder(std::istream& input, std::istream& properties);
+        ~EliasFanoDecoder() = default;
+
+        auto decode() -> EliasFanoGraph<T>;
+};
+
+template <std::unsigned_integral T>
+EliasFanoDecoder<T>::EliasFanoDecoder(std::istream& input, std::istream& properties):
+    input(input), properties(PropertyParser(properties).decode()) {}
+
+template <std::unsigned_integral T>
+auto EliasFanoDecoder<T>::decode() -> EliasFanoGraph<T> {
+    auto words = std::vector<uint64_t>();
+    uint64_t word;
+    while (this->input.read(reinterpret_cast<char*>(&word), sizeof word)) {
+        if constexpr (std::endian::native == std::endian::big)
+            word = byte_swap(word);
+        words.push_back(word);
+    }
+
+    return EliasFanoGraph<T>(std::move(words), this->properties.template as<size_t>("nodes"),
+                             this->properties.template as<size_t>("arcs"),
+                             this->properties.template as<size_t>("skipquantum"),
+                             this->properties.template as<uint64_t>("listbits"));
+}
+
+#endif
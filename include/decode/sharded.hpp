@@ -0,0 +1,141 @@
+#ifndef _JORMUNGANDR_DECODE_SHARDED_HPP
+#define _JORMUNGANDR_DECODE_SHARDED_HPP
+
+#include "decode/webgraph.hpp"
+#include "decode/property.hpp"
+#include "graph/graph.hpp"
+#include "encoding.hpp"
+#include "exceptions.hpp"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <optional>
+#include <algorithm>
+#include <utility>
+
+// Shard i of the sharded graph with the given basename is stored as <basename>-<i>.graph, along
+// with its own .offsets and .properties.
+inline auto shard_path(const std::filesystem::path& basename, size_t shard, const std::string& extension) -> std::filesystem::path {
+    auto path = basename;
+    path += "-" + std::to_string(shard) + extension;
+    return path;
+}
+
+// Presents the shards written by ShardedEncoder as a single graph. Every shard can also be
+// decoded on its own.
+template <typename T>
+class ShardedDecoder {
+    public:
+        using Node = typename WebGraphDecoder<T>::Node;
+
+    private:
+        std::filesystem::path basename;
+        EncodingConfig encoding_config;
+        T total_nodes;
+        // The first node of every shard, followed by the total number of nodes
+        std::vector<T> base_nodes;
+
+        size_t current_shard;
+        std::ifstream input;
+        std::optional<WebGraphDecoder<T>> decoder;
+
+    public:
+        ShardedDecoder(const std::filesystem::path& basename, std::istream& properties);
+
+        ShardedDecoder(const ShardedDecoder&) = delete;
+        ShardedDecoder& operator=(const ShardedDecoder&) = delete;
+
+        auto next_node() -> std::optional<Node>;
+        auto decode() -> Graph<T>;
+
+        // Decode only the given shard, reading from graph
+        auto open_shard(size_t shard, std::ifstream& graph) const -> WebGraphDecoder<T>;
+        auto shard_of(T node) const -> size_t;
+
+        inline auto shard_range(size_t shard) const -> std::pair<T, T> {
+            return {this->base_nodes[shard], this->base_nodes[shard + 1]};
+        }
+
+        inline auto num_shards() const -> size_t {
+            return this->base_nodes.size() - 1;
+        }
+
+        inline auto num_nodes() const -> T {
+            return this->total_nodes;
+        }
+};
+
+template <typename T>
+ShardedDecoder<T>::ShardedDecoder(const std::filesystem::path& basename, std::istream& properties):
+    basename(basename), current_shard(0) {
+    auto property_map = PropertyParser(properties).decode();
+    this->encoding_config = EncodingConfig::from_properties(property_map);
+    this->total_nodes = property_map.as<T>("nodes");
+    this->base_nodes = property_map.as_list<T>("shardbasenodes");
+    if (this->base_nodes.size() != property_map.as<size_t>("shards"))
+        throw PropertyException("Expected a base node for every shard");
+    this->base_nodes.push_back(this->total_nodes);
+    if (!std::is_sorted(this->base_nodes.begin(), this->base_nodes.end()))
+        throw PropertyException("Shards are not in node order");
+}
+
+template <typename T>
+auto ShardedDecoder<T>::next_node() -> std::optional<Node> {
+    while (this->current_shard < this->num_shards()) {
+        if (!this->decoder) {
+            this->input.close();
+            this->input.clear();
+            this->input.open(shard_path(this->basename, this->current_shard, ".graph"), std::ios::binary);
+            if (!this->input)
+                throw IoException("Failed to open shard ", this->current_shard);
+            auto [first, last] = this->shard_range(this->current_shard);
+            this->decoder.emplace(this->input, first, last, this->encoding_config);
+        }
+
+        if (auto node = this->decoder->next_node())
+            return node;
+
+        this->decoder.reset();
+        ++this->current_shard;
+    }
+
+    return std::nullopt;
+}
+
+template <typename T>
+auto ShardedDecoder<T>::decode() -> Graph<T> {
+    auto nodes = std::vector<typename Graph<T>::Node>(this->total_nodes, {0, 0});
+    auto edges = std::vector<T>();
+
+    while (auto node = this->next_node()) {
+        nodes[node->index].first_edge = edges.size();
+        nodes[node->index].num_edges = node->neighbours.size();
+        std::copy(node->neighbours.begin(), node->neighbours.end(), std::back_inserter(edges));
+    }
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+template <typename T>
+auto ShardedDecoder<T>::open_shard(size_t shard, std::ifstream& graph) const -> WebGraphDecoder<T> {
+    if (shard >= this->num_shards())
+        throw EncodingException("Shard ", shard, " out of bounds");
+
+    graph.open(shard_path(this->basename, shard, ".graph"), std::ios::binary);
+    if (!graph)
+        throw IoException("Failed to open shard ", shard);
+
+    auto [first, last] = this->shard_range(shard);
+    return WebGraphDecoder<T>(graph, first, last, this->encoding_config);
+}
+
+template <typename T>
+auto ShardedDecoder<T>::shard_of(T node) const -> size_t {
+    // The last shard containing the node, as empty shards share their base node with the next
+    auto it = std::upper_bound(this->base_nodes.begin(), this->base_nodes.end() - 1, node);
+    return std::max<size_t>(it - this->base_nodes.begin(), 1) - 1;
+}
+
+#endif
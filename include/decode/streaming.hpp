@@ -0,0 +1,159 @@
+#ifndef _JORMUNGANDR_DECODE_STREAMING_HPP
+#define _JORMUNGANDR_DECODE_STREAMING_HPP
+
+#include "decode/webgraph.hpp"
+#include "decode/property.hpp"
+#include "decode/chunks.hpp"
+#include "graph/graph.hpp"
+#include "encoding.hpp"
+#include "exceptions.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <optional>
+
+// Makes repeated sequential passes over a BVGraph on disk, for iterative computations that only
+// need the successor lists in order. Only the reference window is kept in memory, and the decoder
+// is rewound to the start of the graph for every pass. A chunked graph of which the .chunks index
+// is present is split into ranges of chunks of about the same size, which the threads decode in
+// parallel, stealing ranges from each other once they run out.
+template <std::unsigned_integral T>
+class StreamingGraph {
+    private:
+        struct Worker {
+            std::ifstream input;
+            std::optional<WebGraphDecoder<T>> decoder;
+        };
+
+        T total_nodes;
+        EncodingConfig encoding_config;
+        std::vector<ChunkEntry> chunks;
+        // Bounds of the ranges of chunks handed out as tasks
+        std::vector<size_t> task_bounds;
+        std::vector<std::unique_ptr<Worker>> workers;
+
+    public:
+        StreamingGraph(const std::filesystem::path& basename, size_t threads = 1);
+
+        StreamingGraph(const StreamingGraph&) = delete;
+        StreamingGraph& operator=(const StreamingGraph&) = delete;
+
+        // Decode the whole graph, calling f(node, successors) for every node. With multiple
+        // threads, f is called concurrently for nodes in different ranges of chunks.
+        auto for_each(ForEachNodeCallback<T> auto f) -> void;
+        // Call f(state, node, successors) with the state of the calling thread, created by
+        // make_state(thread), and return the states of all threads
+        template <std::invocable<size_t> M, ForEachNodeStateCallback<std::invoke_result_t<M, size_t>, T> F>
+        auto for_each(M make_state, F f) -> std::vector<std::invoke_result_t<M, size_t>>;
+
+        inline auto num_nodes() const -> T {
+            return this->total_nodes;
+        }
+
+        // The number of threads calling f in for_each
+        inline auto num_threads() const -> size_t {
+            return this->workers.size();
+        }
+
+    private:
+        // Call f(thread, node, successors) for every node
+        auto decode_all(auto f) -> void;
+};
+
+template <std::unsigned_integral T>
+StreamingGraph<T>::StreamingGraph(const std::filesystem::path& basename, size_t threads) {
+    auto with_extension = [&](const char* extension) {
+        auto path = basename;
+        path += extension;
+        return path;
+    };
+
+    auto properties_path = with_extension(".properties");
+    auto properties_input = std::ifstream(properties_path);
+    if (!properties_input)
+        throw IoException("Failed to open properties ", properties_path);
+    auto properties = PropertyParser(properties_input).decode();
+    this->encoding_config = EncodingConfig::from_properties(properties);
+    this->total_nodes = properties.as<T>("nodes");
+
+    auto graph_path = with_extension(".graph");
+    auto chunks_path = with_extension(".chunks");
+    if (threads > 1 && this->encoding_config.is_chunked()) {
+        auto chunks_input = std::ifstream(chunks_path, std::ios::binary);
+        if (chunks_input)
+            this->chunks = ChunkIndexDecoder(chunks_input).decode();
+    }
+
+    if (this->chunks.size() < 2) {
+        this->chunks.clear();
+        threads = 1;
+    }
+
+    for (size_t i = 0; i < std::min(threads, std::max<size_t>(this->chunks.size(), 1)); ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->input.open(graph_path, std::ios::binary);
+        if (!worker->input)
+            throw IoException("Failed to open graph file ", graph_path);
+        this->workers.push_back(std::move(worker));
+    }
+
+    if (this->chunks.empty()) {
+        this->workers[0]->decoder.emplace(this->workers[0]->input, 0, this->total_nodes, this->encoding_config);
+        return;
+    }
+
+    // A chunk takes about as long to decode as it is long
+    uint64_t graph_size = std::filesystem::file_size(graph_path);
+    auto chunk_size = [&](size_t chunk) -> size_t {
+        uint64_t end = chunk + 1 < this->chunks.size() ? this->chunks[chunk + 1].offset : graph_size;
+        return end - this->chunks[chunk].offset + 1;
+    };
+    this->task_bounds = split_by_weight(0, this->chunks.size(), this->workers.size() * tasks_per_thread, chunk_size);
+}
+
+template <std::unsigned_integral T>
+auto StreamingGraph<T>::decode_all(auto f) -> void {
+    if (this->chunks.empty()) {
+        auto& decoder = *this->workers[0]->decoder;
+        decoder.rewind();
+        while (auto node = decoder.next_node())
+            f(0, node->index, node->neighbours);
+        return;
+    }
+
+    parallel_for_tasks(this->task_bounds, this->workers.size(), [&](size_t thread, size_t first, size_t last) {
+        auto& input = this->workers[thread]->input;
+        T last_node = last < this->chunks.size() ? this->chunks[last].first_node : this->total_nodes;
+        input.clear();
+        input.seekg(this->chunks[first].offset);
+        auto decoder = WebGraphDecoder<T>(input, this->chunks[first].first_node, last_node, this->encoding_config);
+        while (auto node = decoder.next_node())
+            f(thread, node->index, node->neighbours);
+    });
+}
+
+template <std::unsigned_integral T>
+auto StreamingGraph<T>::for_each(ForEachNodeCallback<T> auto f) -> void {
+    this->decode_all([&](size_t, T node, std::span<const T> successors) {
+        f(node, successors);
+    });
+}
+
+template <std::unsigned_integral T>
+template <std::invocable<size_t> M, ForEachNodeStateCallback<std::invoke_result_t<M, size_t>, T> F>
+auto StreamingGraph<T>::for_each(M make_state, F f) -> std::vector<std::invoke_result_t<M, size_t>> {
+    auto states = std::vector<std::invoke_result_t<M, size_t>>();
+    states.reserve(this->workers.size());
+    for (size_t t = 0; t < this->workers.size(); ++t)
+        states.push_back(make_state(t));
+
+    this->decode_all([&](size_t thread, T node, std::span<const T> successors) {
+        f(states[thread], node, successors);
+    });
+    return states;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _JORMUNGANDR_DECODE_STREAMVBYTE_HPP
+#define _JORMUNGANDR_DECODE_STREAMVBYTE_HPP
+
+#include "decode/property.hpp"
+#include "graph/graph.hpp"
+#include "exceptions.hpp"
+#include "streamvbyte.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include <span>
+#include <optional>
+#include <algorithm>
+#include <cstdint>
+
+// Reads a graph written by StreamVByteEncoder, which is loaded into memory as a whole so that it
+// can be decoded repeatedly.
+template <std::unsigned_integral T>
+class StreamVByteDecoder {
+    public:
+        struct Node {
+            T index;
+            std::span<const T> neighbours;
+        };
+
+    private:
+        // Number of gaps decoded at once, a multiple of the group size
+        constexpr const static size_t batch_size = 4096;
+
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> degrees;
+        size_t total_arcs;
+        const uint8_t* gap_control;
+        const uint8_t* gap_data_start;
+
+        T next_node_index;
+        size_t decoded_gaps;
+        const uint8_t* gap_data;
+        std::vector<uint32_t> batch;
+        size_t batch_offset;
+        std::vector<T> current;
+
+    public:
+        StreamVByteDecoder(std::istream& input, std::istream& properties);
+
+        StreamVByteDecoder(const StreamVByteDecoder&) = delete;
+        StreamVByteDecoder& operator=(const StreamVByteDecoder&) = delete;
+
+        auto next_node() -> std::optional<Node>;
+        // Start decoding from the first node again
+        auto rewind() -> void;
+        auto decode() -> Graph<T>;
+
+        inline auto num_nodes() const -> T {
+            return this->degrees.size();
+        }
+
+    private:
+        auto fill_batch(size_t required) -> void;
+};
+
+template <std::unsigned_integral T>
+StreamVByteDecoder<T>::StreamVByteDecoder(std::istream& input, std::istream& properties) {
+    auto property_map = PropertyParser(properties).decode();
+    size_t nodes = property_map.as<size_t>("nodes");
+    this->total_arcs = property_map.as<size_t>("arcs");
+    size_t degree_data_bytes = property_map.as<size_t>("degreedatabytes");
+    size_t gap_data_bytes = property_map.as<size_t>("gapdatabytes");
+
+    size_t size = streamvbyte_control_bytes(nodes) + degree_data_bytes +
+        streamvbyte_control_bytes(this->total_arcs) + gap_data_bytes;
+    this->bytes.resize(size + streamvbyte_padding, 0);
+    input.read(reinterpret_cast<char*>(this->bytes.data()), size);
+    if (size_t(input.gcount()) != size)
+        throw EncodingException("Stream VByte graph is truncated");
+
+    const uint8_t* degree_control = this->bytes.data();
+    const uint8_t* degree_data = degree_control + streamvbyte_control_bytes(nodes);
+    this->degrees.resize(nodes);
+    streamvbyte_decode(degree_control, degree_data, nodes, this->degrees.data());
+
+    this->gap_control = degree_data + degree_data_bytes;
+    this->gap_data_start = this->gap_control + streamvbyte_control_bytes(this->total_arcs);
+    this->rewind();
+}
+
+template <std::unsigned_integral T>
+auto StreamVByteDecoder<T>::rewind() -> void {
+    this->next_node_index = 0;
+    this->decoded_gaps = 0;
+    this->gap_data = this->gap_data_start;
+    this->batch.clear();
+    this->batch_offset = 0;
+}
+
+template <std::unsigned_integral T>
+auto StreamVByteDecoder<T>::next_node() -> std::optional<Node> {
+    if (this->next_node_index >= this->num_nodes())
+        return std::nullopt;
+
+    T index = this->next_node_index++;
+    size_t degree = this->degrees[index];
+    this->current.resize(degree);
+    if (degree == 0)
+        return {{index, {}}};
+
+    this->fill_batch(degree);
+    const uint32_t* gaps = this->batch.data() + this->batch_offset;
+    this->batch_offset += degree;
+
+    uint32_t first = gaps[0];
+    T value = first % 2 == 0 ? index + first / 2 : index - (first + 1) / 2;
+    this->current[0] = value;
+    for (size_t i = 1; i < degree; ++i) {
+        value += gaps[i];
+        this->current[i] = value;
+    }
+
+    return {{index, this->current}};
+}
+
+template <std::unsigned_integral T>
+auto StreamVByteDecoder<T>::fill_batch(size_t required) -> void {
+    size_t available = this->batch.size() - this->batch_offset;
+    if (available >= required)
+        return;
+
+    // Keep the remaining gaps, and decode whole groups after them
+    std::copy(this->batch.begin() + this->batch_offset, this->batch.end(), this->batch.begin());
+    size_t count = std::max(batch_size, (required - available + 3) / 4 * 4);
+    count = std::min(count, this->total_arcs - this->decoded_gaps);
+    if (count + available < required)
+        throw EncodingException("Stream VByte graph has fewer arcs than its outdegrees");
+
+    this->batch.resize(available + count);
+    this->gap_data = streamvbyte_decode(this->gap_control + this->decoded_gaps / 4, this->gap_data, count,
+                                        this->batch.data() + available);
+    this->decoded_gaps += count;
+    this->batch_offset = 0;
+}
+
+template <std::unsigned_integral T>
+auto StreamVByteDecoder<T>::decode() -> Graph<T> {
+    auto nodes = std::vector<typename Graph<T>::Node>(this->num_nodes(), {0, 0});
+    auto edges = std::vector<T>();
+    edges.reserve(this->total_arcs);
+
+    while (auto node = this->next_node()) {
+        nodes[node->index].first_edge = edges.size();
+        nodes[node->index].num_edges = node->neighbours.size();
+        std::copy(node->neighbours.begin(), node->neighbours.end(), std::back_inserter(edges));
+    }
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+#endif
@@ -5,8 +5,12 @@
 #include <concepts>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <cstdint>
 
 #include "graph/graph.hpp"
+#include "exceptions.hpp"
+#include "utility.hpp"
 
 template <std::unsigned_integral T>
 class TsvDecoder {
@@ -29,13 +33,15 @@ auto TsvDecoder<T>::decode() -> Graph<T> {
     auto dsts = std::vector<T>();
 
     while (this->input) {
-        T src, dst;
+        uint64_t src, dst;
 
         this->input >> src;
         char sep = this->input.get();
         this->input >> dst;
         if (sep != this->sep || this->input.fail())
             break;
+        if (std::max(src, dst) > std::numeric_limits<T>::max())
+            throw EncodingException("Node ", std::max(src, dst), " does not fit in ", bit_size_of<T>(), " bits");
 
         srcs.push_back(src);
         dsts.push_back(dst);
@@ -0,0 +1,116 @@
+#ifndef _JORMUNGANDR_DECODE_VIEW_HPP
+#define _JORMUNGANDR_DECODE_VIEW_HPP
+
+#include "decode/decoder.hpp"
+
+#include <ranges>
+#include <iterator>
+#include <optional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+// The type of the nodes produced by a stream, and of their index
+template <typename S>
+using stream_node_t = std::remove_cvref_t<decltype(*std::declval<S&>().next_node())>;
+
+template <typename S>
+using stream_index_t = std::remove_cvref_t<decltype(std::declval<stream_node_t<S>&>().index)>;
+
+// An input range over the nodes of a NodeStream, such as a WebGraphDecoder, so that it can be
+// consumed by std::ranges algorithms and views. Nodes are decoded one at a time as the range is
+// iterated, so filters, transforms and early exits do not decode more of the stream than they
+// read. Every element has the index of the node and its successors as a std::span, which is only
+// valid until the next node is decoded, as with next_node().
+template <typename S>
+    requires NodeStream<S, stream_index_t<S>>
+class NodeView : public std::ranges::view_interface<NodeView<S>> {
+    public:
+        using Node = stream_node_t<S>;
+
+    private:
+        S* stream = nullptr;
+        std::optional<Node> current;
+
+    public:
+        class Iterator {
+            private:
+                NodeView* view = nullptr;
+
+            public:
+                using value_type = Node;
+                using difference_type = std::ptrdiff_t;
+
+                Iterator() = default;
+                explicit Iterator(NodeView* view): view(view) {}
+
+                inline auto operator*() const -> const Node& {
+                    return *this->view->current;
+                }
+
+                inline auto operator->() const -> const Node* {
+                    return std::addressof(*this->view->current);
+                }
+
+                inline auto operator++() -> Iterator& {
+                    this->view->advance();
+                    return *this;
+                }
+
+                inline auto operator++(int) -> void {
+                    ++*this;
+                }
+
+                inline auto operator==(std::default_sentinel_t) const -> bool {
+                    return !this->view->current;
+                }
+        };
+
+        NodeView() = default;
+        explicit NodeView(S& stream): stream(std::addressof(stream)) {}
+
+        // Decodes the first node not read yet, as the stream can only be read once
+        inline auto begin() -> Iterator {
+            this->advance();
+            return Iterator(this);
+        }
+
+        inline auto end() const -> std::default_sentinel_t {
+            return std::default_sentinel;
+        }
+
+    private:
+        inline auto advance() -> void {
+            this->current = this->stream->next_node();
+        }
+};
+
+// The remaining nodes of stream, as a view
+template <typename S>
+auto nodes(S& stream) -> NodeView<S> {
+    return NodeView<S>(stream);
+}
+
+// The successor lists of the remaining nodes of stream, in node order
+template <typename S>
+auto successor_lists(S& stream) {
+    using T = stream_index_t<S>;
+    return nodes(stream) | std::views::transform([](const auto& node) -> std::span<const T> {
+        return node.neighbours;
+    });
+}
+
+// The remaining arcs of stream, as pairs of source and target
+template <typename S>
+auto arcs(S& stream) {
+    using T = stream_index_t<S>;
+    return nodes(stream) | std::views::transform([](const auto& node) {
+        return node.neighbours | std::views::transform([source = T(node.index)](T target) {
+            return std::pair<T, T>(source, target);
+        });
+    }) | std::views::join;
+}
+
+#endif
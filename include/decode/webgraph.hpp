@@ -6,23 +6,46 @@
 #include "encoding.hpp"
 #include "exceptions.hpp"
 #include "graph/graph.hpp"
+#include "instrumentation.hpp"
+#include "progress.hpp"
+#include "utility.hpp"
 
 #include <algorithm>
 #include <vector>
-#include <iosfwd>
+#include <istream>
 #include <optional>
 #include <string_view>
 #include <span>
+#include <limits>
 #include <cstdint>
 
 template <typename T>
 class WebGraphDecoder {
     private:
+        struct WindowEntry {
+            std::vector<T> neighbours;
+            T out_degree = 0;
+            // Lists of skipped nodes are only merged when referenced, these mark the
+            // start of the still unmerged interval and residual runs.
+            size_t interval_start = 0;
+            size_t residual_start = 0;
+            // Length of the reference chain ending at this node
+            T ref_count = 0;
+            bool merged = true;
+            bool valid = true;
+        };
+
         BitReader input;
-        std::vector<std::vector<T>> window;
+        std::vector<WindowEntry> window;
         EncodingConfig encoding_config;
-        T num_nodes;
+        // First node of the reference window, which for chunked graphs is the start of the current chunk
+        T first_node;
+        T total_nodes;
         T next_node_index;
+        uint64_t chunk_start;
+        // The node at which decoding started
+        T start_node;
+        ProgressReporter* progress = nullptr;
 
     public:
         struct Node {
@@ -30,70 +53,237 @@ class WebGraphDecoder {
             std::span<const T> neighbours;
         };
 
+        struct WindowNode {
+            T index;
+            std::span<const T> neighbours;
+            T ref_count;
+        };
+
+        enum class SkipMode {
+            // Keep enough of the skipped list so that later nodes can still be decoded using next_node()
+            KEEP_WINDOW,
+            // Only keep track of the outdegree. Calling next_node() afterwards fails if it references
+            // a node skipped this way.
+            DEGREES_ONLY
+        };
+
         WebGraphDecoder(std::istream& input, T num_nodes, EncodingConfig encoding_config);
+        // Decode the nodes in [first_node, num_nodes), of which the reference window starts at first_node
+        WebGraphDecoder(std::istream& input, T first_node, T num_nodes, EncodingConfig encoding_config);
+        // Decode the nodes in [start_node, num_nodes) without the lists before start_node, so that nodes
+        // referencing those can only be skipped. The input is positioned at the byte containing the code
+        // of start_node, which starts bit_offset bits into that byte. Such a decoder cannot be rewound.
+        // Lists copying from the window before start_node can only be skipped once the outdegrees of
+        // that window are restored with restore_outdegree().
+        WebGraphDecoder(std::istream& input, T first_node, T start_node, uint8_t bit_offset, T num_nodes,
+                        EncodingConfig encoding_config);
         WebGraphDecoder(std::istream& input, std::istream& properties);
+        // Decode only the given chunk of a chunked graph, of which chunks is the index
+        static auto for_chunk(std::istream& input, const std::vector<ChunkEntry>& chunks, size_t chunk,
+                              T num_nodes, EncodingConfig encoding_config) -> WebGraphDecoder;
+
         auto next_node() -> std::optional<Node>;
+        // Advance past the next node, returning its outdegree.
+        auto skip_node(SkipMode mode = SkipMode::KEEP_WINDOW) -> std::optional<T>;
         auto decode() -> Graph<T>;
+        // Start decoding from the first node again, for another pass over the graph. The input
+        // must be seekable.
+        auto rewind() -> void;
+        // Report progress to progress after every refill of the input buffer. The decoder must not
+        // be moved afterwards.
+        auto set_progress(ProgressReporter& progress) -> void;
+        // Set the outdegree of a node in the window before the start node
+        auto restore_outdegree(T index, T out_degree) -> void;
+
+        // The nodes which the next node may reference, oldest first. Fails if any of them was
+        // skipped with DEGREES_ONLY.
+        auto window_nodes() -> std::vector<WindowNode>;
+
+        inline auto num_nodes() const -> T {
+            return this->total_nodes;
+        }
+
+        // Number of bits read from the input so far
+        inline auto bit_position() const -> uint64_t {
+            return this->input.bit_position();
+        }
+
+        // The first node and bit position of the chunk containing the last decoded node
+        inline auto chunk_first_node() const -> T {
+            return this->first_node;
+        }
+
+        inline auto chunk_start_position() const -> uint64_t {
+            return this->chunk_start;
+        }
 
     private:
-        auto decode_reference_list(T index, std::vector<T>& to) -> void;
+        // Hook the progress reporter into the input, counting the arcs in edges if given
+        auto watch_progress(const std::vector<T>* edges) -> void;
+        auto begin_node(T index) -> WindowEntry&;
+        auto decode_reference(T index, WindowEntry& entry) -> T;
+        auto decode_lists(T index, T reference, WindowEntry& entry) -> void;
+        auto skip_lists(T index, T reference, T out_degree) -> void;
+        auto merge_entry(WindowEntry& entry) -> void;
+        auto referenced_entry(T index, T reference) -> WindowEntry&;
+        auto decode_reference_list(T index, T reference, std::vector<T>& to) -> void;
         auto decode_interval_list(T index, std::vector<T>& to) -> void;
         auto decode_residual_list(T index, T n, std::vector<T>& to) -> void;
-        auto decode_value(Encoding encoding) -> T;
-        auto decode_maybe_negative(T index, Encoding encoding) -> T;
+        auto read_value(Encoding encoding, uint32_t golomb_b = 0) -> uint64_t;
+        // Read a value, failing if it does not fit in T
+        auto decode_value(Encoding encoding, uint32_t golomb_b = 0) -> T;
+        auto decode_maybe_negative(T index, Encoding encoding, uint32_t golomb_b = 0) -> T;
 };
 
 template <typename T>
 WebGraphDecoder<T>::WebGraphDecoder(std::istream& input, T num_nodes, EncodingConfig encoding_config):
-    input(input), window(encoding_config.window_size + 1),
-    encoding_config(encoding_config), num_nodes(num_nodes), next_node_index(0) {}
+    WebGraphDecoder(input, 0, num_nodes, encoding_config) {}
+
+template <typename T>
+WebGraphDecoder<T>::WebGraphDecoder(std::istream& input, T first_node, T num_nodes, EncodingConfig encoding_config):
+    input(input), window(encoding_config.window_size + 1), encoding_config(encoding_config),
+    first_node(first_node), total_nodes(num_nodes), next_node_index(first_node), chunk_start(0),
+    start_node(first_node) {}
+
+template <typename T>
+WebGraphDecoder<T>::WebGraphDecoder(std::istream& input, T first_node, T start_node, uint8_t bit_offset, T num_nodes,
+                                    EncodingConfig encoding_config):
+    WebGraphDecoder(input, first_node, num_nodes, encoding_config) {
+    this->next_node_index = start_node;
+    this->start_node = start_node;
+    for (auto& entry : this->window)
+        entry.valid = false;
+    if (bit_offset > 0)
+        this->input.read_bits(bit_offset);
+}
 
 template <typename T>
 WebGraphDecoder<T>::WebGraphDecoder(std::istream& input, std::istream& properties):
-    input(input), next_node_index(0) {
+    input(input), first_node(0), next_node_index(0), chunk_start(0), start_node(0) {
     auto property_map = PropertyParser(properties).decode();
-    this->num_nodes = property_map.as<T>("nodes");
+    // A shard of a sharded graph holds the nodes starting at basenode
+    this->first_node = property_map.maybe_as<T>("basenode").value_or(0);
+    this->next_node_index = this->first_node;
+    this->start_node = this->first_node;
+    this->total_nodes = this->first_node + property_map.as<T>("nodes");
     this->encoding_config = EncodingConfig::from_properties(property_map);
     this->window.resize(this->encoding_config.window_size + 1);
 }
 
+template <typename T>
+auto WebGraphDecoder<T>::for_chunk(std::istream& input, const std::vector<ChunkEntry>& chunks, size_t chunk,
+                                   T num_nodes, EncodingConfig encoding_config) -> WebGraphDecoder {
+    if (chunk >= chunks.size())
+        throw EncodingException("Chunk ", chunk, " out of bounds");
+
+    T last = chunk + 1 < chunks.size() ? chunks[chunk + 1].first_node : num_nodes;
+    input.clear();
+    input.seekg(chunks[chunk].offset);
+    return WebGraphDecoder(input, chunks[chunk].first_node, last, encoding_config);
+}
+
 template <typename T>
 auto WebGraphDecoder<T>::next_node() -> std::optional<Node> {
-    if (this->next_node_index >= this->num_nodes) {
+    if (this->next_node_index >= this->total_nodes) {
         return std::nullopt;
     }
 
     T index = this->next_node_index++;
-    auto& neighbours = this->window[index % this->window.size()];
-    neighbours.clear();
-
-    T out_degree = this->decode_value(this->encoding_config.outdegree_encoding);
-    if (out_degree == 0)
+    JORMUNGANDR_COUNT(DECODER_NODES, 1);
+    auto& entry = this->begin_node(index);
+    entry.out_degree = this->decode_value(this->encoding_config.outdegree_encoding,
+                                          this->encoding_config.outdegree_golomb_b);
+    if (entry.out_degree == 0)
         return {{index, {}}};
 
-    if (this->encoding_config.window_size > 0) {
-        this->decode_reference_list(index, neighbours);
+    T reference = this->decode_reference(index, entry);
+    this->decode_lists(index, reference, entry);
+    this->merge_entry(entry);
+
+    return {{index, entry.neighbours}};
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::skip_node(SkipMode mode) -> std::optional<T> {
+    if (this->next_node_index >= this->total_nodes) {
+        return std::nullopt;
     }
 
-    if (this->encoding_config.min_interval_size > 0 && neighbours.size() < out_degree) {
-        size_t mid = neighbours.size();
-        this->decode_interval_list(index, neighbours);
-        std::inplace_merge(neighbours.begin(), neighbours.begin() + mid, neighbours.end());
+    T index = this->next_node_index++;
+    auto& entry = this->begin_node(index);
+    entry.out_degree = this->decode_value(this->encoding_config.outdegree_encoding,
+                                          this->encoding_config.outdegree_golomb_b);
+    if (entry.out_degree == 0)
+        return entry.out_degree;
+
+    T reference = this->decode_reference(index, entry);
+
+    // Without a window no later node can reference this list, so there is nothing to keep. A list
+    // copying from a skipped list cannot be kept either, but may still be skipped over.
+    if (mode == SkipMode::DEGREES_ONLY || this->encoding_config.window_size == 0 ||
+        (reference != 0 && !this->referenced_entry(index, reference).valid)) {
+        JORMUNGANDR_COUNT(DECODER_SKIPPED_NODES, 1);
+        this->skip_lists(index, reference, entry.out_degree);
+        entry.valid = false;
+    } else {
+        this->decode_lists(index, reference, entry);
     }
 
-    if (neighbours.size() < out_degree) {
-        size_t mid = neighbours.size();
-        this->decode_residual_list(index, out_degree - neighbours.size(), neighbours);
-        std::inplace_merge(neighbours.begin(), neighbours.begin() + mid, neighbours.end());
+    return entry.out_degree;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::begin_node(T index) -> WindowEntry& {
+    if (index > this->first_node &&
+        this->encoding_config.starts_chunk(index - this->first_node, this->input.bit_position() - this->chunk_start)) {
+        this->input.align();
+        this->first_node = index;
+        this->chunk_start = this->input.bit_position();
     }
 
-    return {{index, neighbours}};
+    auto& entry = this->window[index % this->window.size()];
+    entry.neighbours.clear();
+    entry.merged = true;
+    entry.valid = true;
+    entry.ref_count = 0;
+    return entry;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::rewind() -> void {
+    this->input.rewind();
+    this->first_node = this->start_node;
+    this->next_node_index = this->start_node;
+    this->chunk_start = 0;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::restore_outdegree(T index, T out_degree) -> void {
+    this->window[index % this->window.size()].out_degree = out_degree;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::set_progress(ProgressReporter& progress) -> void {
+    this->progress = &progress;
+    this->watch_progress(nullptr);
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::watch_progress(const std::vector<T>* edges) -> void {
+    if (!this->progress)
+        return;
+
+    this->input.on_progress([this, edges]() {
+        this->progress->update(this->next_node_index - this->start_node, this->total_nodes - this->start_node,
+                               edges ? edges->size() : 0, this->input.bit_position() / bit_size_of<uint8_t>());
+    });
 }
 
 template <typename T>
 auto WebGraphDecoder<T>::decode() -> Graph<T> {
-    auto nodes = std::vector<typename Graph<T>::Node>(this->num_nodes, {0, 0});
+    auto nodes = std::vector<typename Graph<T>::Node>(this->total_nodes, {0, 0});
     auto edges = std::vector<T>();
+    this->watch_progress(&edges);
 
     while (auto node = this->next_node()) {
         nodes[node->index].first_edge = edges.size();
@@ -101,38 +291,165 @@ auto WebGraphDecoder<T>::decode() -> Graph<T> {
         std::copy(node->neighbours.begin(), node->neighbours.end(), std::back_inserter(edges));
     }
 
+    if (this->progress) {
+        this->progress->finish(this->next_node_index - this->start_node, this->total_nodes - this->start_node,
+                               edges.size(), this->input.bit_position() / bit_size_of<uint8_t>());
+        this->watch_progress(nullptr);
+    }
+
     return Graph<T>(std::move(nodes), std::move(edges));
 }
 
 template <typename T>
-auto WebGraphDecoder<T>::decode_reference_list(T index, std::vector<T>& to) -> void {
+auto WebGraphDecoder<T>::window_nodes() -> std::vector<WindowNode> {
+    T decoded = this->next_node_index - this->first_node;
+    T count = std::min<T>(decoded, this->encoding_config.window_size);
+
+    auto nodes = std::vector<WindowNode>();
+    nodes.reserve(count);
+    for (T index = this->next_node_index - count; index < this->next_node_index; ++index) {
+        auto& entry = this->window[index % this->window.size()];
+        if (!entry.valid)
+            throw EncodingException("Window contains a list that was skipped");
+        this->merge_entry(entry);
+        nodes.push_back({index, entry.neighbours, entry.ref_count});
+    }
+
+    return nodes;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::decode_reference(T index, WindowEntry& entry) -> T {
+    if (this->encoding_config.window_size == 0)
+        return 0;
+
     T reference = this->decode_value(this->encoding_config.reference_encoding);
-    if (reference == 0)
+    if (reference != 0)
+        entry.ref_count = this->referenced_entry(index, reference).ref_count + 1;
+    return reference;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::decode_lists(T index, T reference, WindowEntry& entry) -> void {
+    auto& neighbours = entry.neighbours;
+    T out_degree = entry.out_degree;
+
+    if (reference != 0) {
+        this->decode_reference_list(index, reference, neighbours);
+    }
+
+    entry.interval_start = neighbours.size();
+    if (this->encoding_config.min_interval_size > 0 && neighbours.size() < out_degree) {
+        this->decode_interval_list(index, neighbours);
+    }
+
+    entry.residual_start = neighbours.size();
+    if (neighbours.size() < out_degree) {
+        this->decode_residual_list(index, out_degree - neighbours.size(), neighbours);
+    }
+
+    JORMUNGANDR_COUNT(DECODER_COPIED_ARCS, entry.interval_start);
+    JORMUNGANDR_COUNT(DECODER_INTERVAL_ARCS, entry.residual_start - entry.interval_start);
+    JORMUNGANDR_COUNT(DECODER_RESIDUAL_ARCS, neighbours.size() - entry.residual_start);
+    entry.merged = false;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::skip_lists(T index, T reference, T out_degree) -> void {
+    T decoded = 0;
+
+    if (reference != 0) {
+        // Only the length of the referenced list is required to find the number of copied nodes
+        T referenced_degree = this->referenced_entry(index, reference).out_degree;
+        T blocks = this->decode_value(this->encoding_config.block_count_encoding);
+        T offset = 0;
+        T i = 0;
+        for (; i < blocks; ++i) {
+            T block_size = this->decode_value(this->encoding_config.copy_block_encoding,
+                                                this->encoding_config.copy_block_golomb_b);
+            if (i > 0)
+                ++block_size;
+
+            if (i % 2 == 0)
+                decoded += block_size;
+            offset += block_size;
+        }
+
+        if (offset > referenced_degree)
+            throw EncodingException("Copy list out of bounds");
+
+        if (i % 2 == 0)
+            decoded += referenced_degree - offset;
+    }
+
+    if (this->encoding_config.min_interval_size > 0 && decoded < out_degree) {
+        T intervals = this->decode_value(this->encoding_config.interval_count_encoding);
+        auto interval_encoding = this->encoding_config.interval_encoding;
+        for (T i = 0; i < intervals; ++i) {
+            this->decode_value(interval_encoding);
+            decoded += this->decode_value(interval_encoding) + this->encoding_config.min_interval_size;
+        }
+    }
+
+    if (decoded < out_degree) {
+        auto golomb_b = this->encoding_config.residual_golomb_b;
+        this->decode_value(this->encoding_config.residual_encoding_start, golomb_b);
+        for (++decoded; decoded < out_degree; ++decoded)
+            this->decode_value(this->encoding_config.residual_encoding, golomb_b);
+    }
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::merge_entry(WindowEntry& entry) -> void {
+    if (entry.merged)
         return;
 
-    if (index < reference)
+    JORMUNGANDR_TIME(DECODER_MERGE);
+    JORMUNGANDR_COUNT(DECODER_MERGES, 1);
+    JORMUNGANDR_COUNT(DECODER_MERGED_ARCS, entry.neighbours.size());
+    auto& neighbours = entry.neighbours;
+    std::inplace_merge(neighbours.begin(), neighbours.begin() + entry.interval_start,
+                       neighbours.begin() + entry.residual_start);
+    std::inplace_merge(neighbours.begin(), neighbours.begin() + entry.residual_start, neighbours.end());
+    entry.merged = true;
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::referenced_entry(T index, T reference) -> WindowEntry& {
+    if (index - this->first_node < reference)
         throw EncodingException("Invalid node reference");
 
-    const auto referenced = this->window[(index - reference + this->window.size()) % this->window.size()];
+    return this->window[(index - reference + this->window.size()) % this->window.size()];
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::decode_reference_list(T index, T reference, std::vector<T>& to) -> void {
+    auto& entry = this->referenced_entry(index, reference);
+    if (!entry.valid)
+        throw EncodingException("Node references a list that was skipped");
+    this->merge_entry(entry);
+
+    const auto& referenced = entry.neighbours;
     T blocks = this->decode_value(this->encoding_config.block_count_encoding);
     T offset = 0;
     T i = 0;
     for (; i < blocks; ++i) {
-        T block_size = this->decode_value(this->encoding_config.copy_block_encoding);
+        T block_size = this->decode_value(this->encoding_config.copy_block_encoding,
+                                                this->encoding_config.copy_block_golomb_b);
         if (i > 0)
             ++block_size;
 
         if (i % 2 == 0) {
             if (offset + block_size > referenced.size())
                 throw EncodingException("Copy list out of bounds");
-            std::copy(&referenced[offset], &referenced[offset + block_size], std::back_inserter(to));
+            std::copy(referenced.begin() + offset, referenced.begin() + offset + block_size, std::back_inserter(to));
         }
 
         offset += block_size;
     }
 
-    if (i % 2 == 0)
-        std::copy(&referenced[offset], &*referenced.end(), std::back_inserter(to));
+    if (i % 2 == 0 && offset < referenced.size())
+        std::copy(referenced.begin() + offset, referenced.end(), std::back_inserter(to));
 }
 
 template <typename T>
@@ -163,11 +480,12 @@ auto WebGraphDecoder<T>::decode_interval_list(T index, std::vector<T>& to) -> vo
 
 template <typename T>
 auto WebGraphDecoder<T>::decode_residual_list(T index, T n, std::vector<T>& to) -> void {
+    auto golomb_b = this->encoding_config.residual_golomb_b;
     T prev = 0;
     for (T i = 0; i < n; ++i) {
         T residual = i == 0 ?
-            this->decode_maybe_negative(index, this->encoding_config.residual_encoding_start) :
-            this->decode_value(this->encoding_config.residual_encoding) + prev;
+            this->decode_maybe_negative(index, this->encoding_config.residual_encoding_start, golomb_b) :
+            this->decode_value(this->encoding_config.residual_encoding, golomb_b) + prev;
 
         to.push_back(residual);
         prev = residual + 1;
@@ -175,7 +493,7 @@ auto WebGraphDecoder<T>::decode_residual_list(T index, T n, std::vector<T>& to)
 }
 
 template <typename T>
-auto WebGraphDecoder<T>::decode_value(Encoding encoding) -> T {
+auto WebGraphDecoder<T>::read_value(Encoding encoding, uint32_t golomb_b) -> uint64_t {
     switch (encoding) {
         case Encoding::DELTA:
             return this->input.read_delta();
@@ -187,19 +505,40 @@ auto WebGraphDecoder<T>::decode_value(Encoding encoding) -> T {
             return this->input.read_zeta(this->encoding_config.zeta_k);
         case Encoding::PRED_SIZE:
             return this->input.read_pred_size(this->encoding_config.pred_size);
+        case Encoding::GOLOMB:
+            if (golomb_b == 0)
+                throw EncodingException("Golomb coding requires a parameter");
+            return this->input.read_golomb(golomb_b);
+        case Encoding::NIBBLE:
+            return this->input.read_nibble();
+    }
+    throw EncodingException("Invalid encoding");
+}
+
+template <typename T>
+auto WebGraphDecoder<T>::decode_value(Encoding encoding, uint32_t golomb_b) -> T {
+    uint64_t value = this->read_value(encoding, golomb_b);
+    if constexpr (sizeof(T) < sizeof(uint64_t)) {
+        if (value > std::numeric_limits<T>::max())
+            throw EncodingException("Value ", value, " does not fit in ", bit_size_of<T>(), " bits");
     }
+    return value;
 }
 
 template <typename T>
-auto WebGraphDecoder<T>::decode_maybe_negative(T index, Encoding encoding) -> T {
-    T value = this->decode_value(encoding);
+auto WebGraphDecoder<T>::decode_maybe_negative(T index, Encoding encoding, uint32_t golomb_b) -> T {
+    // The coded value is up to twice the largest node, so it is kept in 64 bits
+    uint64_t value = this->read_value(encoding, golomb_b);
 
     if (value % 2 == 0) {
         // Positive
-        return index + value / 2;
+        uint64_t node = index + value / 2;
+        if (node < index || node > std::numeric_limits<T>::max())
+            throw EncodingException("Node index ", node, " out of bounds");
+        return node;
     } else {
         // Negative
-        T v = (value + 1) / 2;
+        uint64_t v = value / 2 + 1;
         if (index < v)
             throw EncodingException("Negative node index out of bounds");
         return index - v;
@@ -0,0 +1,229 @@
+#ifndef _JORMUNGANDR_ENCODE_APPEND_HPP
+#define _JORMUNGANDR_ENCODE_APPEND_HPP
+
+#include "encode/webgraph.hpp"
+#include "encode/statistics.hpp"
+#include "decode/webgraph.hpp"
+#include "decode/property.hpp"
+#include "decode/chunks.hpp"
+#include "encode/chunks.hpp"
+#include "graph/propertymap.hpp"
+#include "encoding.hpp"
+#include "exceptions.hpp"
+
+#include <span>
+#include <fstream>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Appends nodes to an existing BVGraph. Only the reference window at the end of the graph is
+// needed to continue the encoding, which is restored by decoding the tail of the file. Where that
+// tail starts is stored in the tailnode and tailoffset properties, along with the outdegrees of
+// the window before it in taildegrees, so that the next append can seek to it. Graphs without
+// them are scanned from the start, only parsing the codes of the nodes before the tail. The chunk
+// index of a chunked graph is extended with the chunks of the appended nodes.
+template <typename T>
+class WebGraphAppender {
+    private:
+        std::fstream output;
+        std::filesystem::path graph_path;
+        PropertyMap properties;
+        EncodingConfig encoding_config;
+        uint64_t start_bit;
+        T existing_nodes;
+        // Bit offsets of the nodes from tail_start on, and outdegrees of the nodes from degrees_start
+        // on, which an unchunked graph needs to restore the window before its tail
+        T tail_start;
+        std::vector<uint64_t> offsets;
+        T degrees_start;
+        std::vector<T> degrees;
+        std::optional<WebGraphEncoder<T>> encoder;
+
+        // The first node of the lists needed to restore the window at the end of a graph of num_nodes nodes
+        auto tail_node(T num_nodes) const -> T;
+
+    public:
+        WebGraphAppender(const std::filesystem::path& graph_path, std::istream& properties);
+
+        WebGraphAppender(const WebGraphAppender&) = delete;
+        WebGraphAppender& operator=(const WebGraphAppender&) = delete;
+
+        WebGraphAppender(WebGraphAppender&&) = delete;
+        WebGraphAppender& operator=(WebGraphAppender&&) = delete;
+
+        // Encode the successors of the next node, starting at the number of nodes of the existing graph.
+        auto push_node(std::span<const T> neighbours) -> void;
+        // Write the appended nodes, and return the properties of the whole graph.
+        auto finish() -> PropertyMap;
+
+        // The index of the first appended node
+        inline auto first_node() const -> T {
+            return this->existing_nodes;
+        }
+};
+
+template <typename T>
+WebGraphAppender<T>::WebGraphAppender(const std::filesystem::path& graph_path, std::istream& properties):
+    graph_path(graph_path) {
+    this->properties = PropertyParser(properties).decode();
+    this->encoding_config = EncodingConfig::from_properties(this->properties);
+    T num_nodes = this->properties.template as<T>("nodes");
+    this->existing_nodes = num_nodes;
+
+    auto input = std::ifstream(graph_path, std::ios::binary);
+    if (!input)
+        throw IoException("Failed to open graph file ", graph_path);
+
+    bool chunked = this->encoding_config.is_chunked();
+    T keep_from = this->tail_node(num_nodes);
+    this->tail_start = keep_from;
+    this->degrees_start = keep_from - std::min<T>(keep_from, this->encoding_config.window_size);
+
+    auto stored_node = this->properties.template maybe_as<T>("tailnode");
+    auto stored_offset = this->properties.template maybe_as<uint64_t>("tailoffset");
+    auto stored_degrees = std::vector<T>();
+    auto degrees_property = this->properties.template maybe_as<std::string>("taildegrees");
+    if (degrees_property && !degrees_property->empty())
+        stored_degrees = this->properties.template as_list<T>("taildegrees");
+    // The tail of a chunked graph starts a chunk, so no list in it references a list before it
+    bool seek_tail = stored_node && stored_offset && (chunked ? *stored_node <= keep_from :
+        *stored_node == keep_from && stored_degrees.size() == keep_from - this->degrees_start);
+
+    // Bit offset in the graph of the start of the input of the decoder
+    uint64_t input_start = 0;
+    T node = 0;
+    auto decoder = std::optional<WebGraphDecoder<T>>();
+    if (seek_tail) {
+        input_start = *stored_offset - *stored_offset % bit_size_of<uint8_t>();
+        input.seekg(input_start / bit_size_of<uint8_t>());
+        if (!input)
+            throw IoException("Failed to read graph file ", graph_path);
+        node = *stored_node;
+        decoder.emplace(input, chunked ? node : 0, node, *stored_offset % bit_size_of<uint8_t>(), num_nodes,
+                        this->encoding_config);
+        if (!chunked) {
+            this->degrees = stored_degrees;
+            for (size_t i = 0; i < stored_degrees.size(); ++i)
+                decoder->restore_outdegree(this->degrees_start + i, stored_degrees[i]);
+        }
+    } else {
+        decoder.emplace(input, num_nodes, this->encoding_config);
+    }
+
+    for (; node < num_nodes; ++node) {
+        if (node >= keep_from)
+            this->offsets.push_back(input_start + decoder->bit_position());
+        auto degree = decoder->skip_node(node < keep_from ? WebGraphDecoder<T>::SkipMode::DEGREES_ONLY :
+                                         WebGraphDecoder<T>::SkipMode::KEEP_WINDOW);
+        if (!chunked && node >= this->degrees_start)
+            this->degrees.push_back(*degree);
+    }
+
+    this->start_bit = input_start + decoder->bit_position();
+    size_t partial_bits = this->start_bit % bit_size_of<uint8_t>();
+    uint8_t partial_byte = 0;
+    if (partial_bits > 0) {
+        input.clear();
+        input.seekg(this->start_bit / bit_size_of<uint8_t>());
+        partial_byte = input.get();
+        if (!input)
+            throw IoException("Failed to read graph file ", graph_path);
+    }
+
+    this->output.open(graph_path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!this->output)
+        throw IoException("Failed to open graph file ", graph_path);
+    this->output.seekp(this->start_bit / bit_size_of<uint8_t>());
+
+    this->encoder.emplace(this->output, this->encoding_config);
+    this->encoder->resume(num_nodes, this->start_bit, partial_byte);
+    for (const auto& window_node : decoder->window_nodes())
+        this->encoder->restore_window_node(window_node.index, window_node.neighbours, window_node.ref_count);
+    if (this->encoding_config.is_chunked() && num_nodes > 0)
+        this->encoder->restore_chunk(decoder->chunk_first_node(), input_start + decoder->chunk_start_position());
+    this->encoder->record_offsets(this->offsets);
+}
+
+template <typename T>
+auto WebGraphAppender<T>::tail_node(T num_nodes) const -> T {
+    // A node in the last window may follow a chain of at most max_ref_count references back,
+    // so lists before that can never be needed to restore the window.
+    uint64_t window = this->encoding_config.window_size;
+    uint64_t needed = window + window * this->encoding_config.max_ref_count;
+    return needed >= num_nodes ? 0 : num_nodes - needed;
+}
+
+template <typename T>
+auto WebGraphAppender<T>::push_node(std::span<const T> neighbours) -> void {
+    this->encoder->push_node(neighbours);
+    if (!this->encoding_config.is_chunked())
+        this->degrees.push_back(neighbours.size());
+}
+
+template <typename T>
+auto WebGraphAppender<T>::finish() -> PropertyMap {
+    this->encoder->finish();
+    uint64_t end_bit = this->encoder->position();
+    auto new_chunks = this->encoder->chunk_index();
+    auto stats = EncodingStatistics::from_properties(this->properties);
+    stats += this->encoder->statistics();
+    this->encoder.reset();
+
+    this->output.close();
+    if (!this->output)
+        throw IoException("Failed to write graph file ", this->graph_path);
+
+    // Anything after the old last code that was not overwritten is no longer part of the graph
+    std::filesystem::resize_file(this->graph_path, (end_bit + bit_size_of<uint8_t>() - 1) / bit_size_of<uint8_t>());
+
+    auto chunks = std::vector<ChunkEntry>();
+    if (this->encoding_config.is_chunked()) {
+        auto index_path = std::filesystem::path(this->graph_path).replace_extension(".chunks");
+        if (this->existing_nodes > 0) {
+            auto index_input = std::ifstream(index_path, std::ios::binary);
+            if (!index_input)
+                throw IoException("Failed to open chunk index ", index_path);
+            chunks = ChunkIndexDecoder(index_input).decode();
+        }
+        chunks.insert(chunks.end(), new_chunks.begin(), new_chunks.end());
+
+        auto index_output = std::ofstream(index_path, std::ios::binary);
+        if (!index_output)
+            throw IoException("Failed to write chunk index ", index_path);
+        ChunkIndexEncoder(index_output).encode(chunks);
+    }
+
+    // Where the next append starts restoring the window, which for a chunked graph is the start
+    // of the chunk containing the tail, as lists never reference across chunks
+    T total_nodes = stats.nodes;
+    T tail = this->tail_node(total_nodes);
+    uint64_t tail_offset = tail < total_nodes ? this->offsets[tail - this->tail_start] : end_bit;
+    auto tail_degrees = std::vector<T>();
+    if (this->encoding_config.is_chunked()) {
+        auto chunk = std::find_if(chunks.rbegin(), chunks.rend(), [&](const ChunkEntry& entry) {
+            return entry.first_node <= tail;
+        });
+        tail = chunk != chunks.rend() ? chunk->first_node : 0;
+        tail_offset = chunk != chunks.rend() ? chunk->offset * bit_size_of<uint8_t>() : 0;
+    } else {
+        T first = tail - std::min<T>(tail, this->encoding_config.window_size);
+        tail_degrees.assign(this->degrees.begin() + (first - this->degrees_start),
+                            this->degrees.begin() + (tail - this->degrees_start));
+    }
+
+    auto result = this->properties;
+    stats.to_properties(result);
+    result.set("nodes", stats.nodes);
+    result.set("arcs", stats.arcs);
+    result.set("tailnode", tail);
+    result.set("tailoffset", tail_offset);
+    if (!tail_degrees.empty())
+        result.set_list("taildegrees", tail_degrees);
+    return result;
+}
+
+#endif
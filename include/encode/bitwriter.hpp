@@ -2,6 +2,7 @@
 #define _JORMUNGANDR_ENCODE_BITWRITER_HPP
 
 #include <iosfwd>
+#include <functional>
 #include <bit>
 #include <cstdint>
 #include "bitbuffer.hpp"
@@ -11,6 +12,10 @@ class BitWriter {
         std::ostream& output;
         uint64_t current_output;
         size_t output_offset;
+        uint64_t bits_written;
+        std::function<void()> progress_callback;
+        uint64_t progress_interval_bits;
+        uint64_t next_progress_bits;
 
         void flush_buffer();
     public:
@@ -34,9 +39,19 @@ class BitWriter {
         auto write_minimal_binary(uint64_t value, uint64_t z) -> void;
         auto write_zeta(uint64_t value, uint64_t k) -> void;
         auto write_golomb(uint64_t value, uint64_t b) -> void;
+        auto write_nibble(uint64_t value) -> void;
         auto write_pred_size(uint64_t value, uint64_t size) -> void;
 
+        // Call callback whenever another interval_bytes have been written, such as to report progress
+        auto on_progress(std::function<void()> callback, uint64_t interval_bytes = 1 << 16) -> void;
+
+        // Pad with zeros up to the next byte boundary
+        auto align() -> void;
         auto flush() -> void;
+
+        inline auto written_bits() const -> uint64_t {
+            return this->bits_written;
+        }
 };
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef _JORMUNGANDR_ENCODE_CHUNKS_HPP
+#define _JORMUNGANDR_ENCODE_CHUNKS_HPP
+
+#include <iosfwd>
+#include <vector>
+
+#include "encoding.hpp"
+
+// Writes the index of a chunked graph as, for every chunk, its first node followed by its offset
+// in bytes, both as big-endian 64-bit integers.
+class ChunkIndexEncoder {
+    private:
+        std::ostream& output;
+    public:
+        ChunkIndexEncoder(std::ostream&);
+        ~ChunkIndexEncoder() = default;
+
+        auto encode(const std::vector<ChunkEntry>&) -> void;
+};
+
+#endif
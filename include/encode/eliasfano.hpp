@@ -0,0 +1,49 @@
+#ifndef _JORMUNGANDR_ENCODE_ELIASFANO_HPP
+#define _JORMUNGANDR_ENCODE_ELIASFANO_HPP
+
+#include "graph/eliasfano.hpp"
+#include "graph/graph.hpp"
+#include "graph/propertymap.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+#include <bit>
+
+// Writes a graph as an EliasFanoGraph, of which the words are stored in little-endian order.
+// The parameters required to read it back are returned as properties.
+template <std::unsigned_integral T>
+class EliasFanoEncoder {
+    private:
+        std::ostream& output;
+        const Graph<T>& graph;
+        size_t quantum;
+    public:
+        EliasFanoEncoder(std::ostream&, const Graph<T>&, size_t quantum = EliasFanoGraph<T>::default_quantum);
+        ~EliasFanoEncoder() = default;
+
+        auto encode() -> PropertyMap;
+};
+
+template <std::unsigned_integral T>
+EliasFanoEncoder<T>::EliasFanoEncoder(std::ostream& output, const Graph<T>& graph, size_t quantum) :
+    output(output), graph(graph), quantum(quantum) {}
+
+template <std::unsigned_integral T>
+auto EliasFanoEncoder<T>::encode() -> PropertyMap {
+    auto ef = EliasFanoGraph<T>(this->graph, this->quantum);
+    for (auto word : ef.data()) {
+        if constexpr (std::endian::native == std::endian::big)
+            word = byte_swap(word);
+        this->output.write(reinterpret_cast<const char*>(&word), sizeof word);
+    }
+
+    auto prop = PropertyMap();
+    prop.set("graphclass", "jormungandr.EliasFanoGraph");
+    prop.set("nodes", ef.num_nodes());
+    prop.set("arcs", ef.num_arcs());
+    prop.set("skipquantum", ef.skip_quantum());
+    prop.set("listbits", ef.list_bits());
+    return prop;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _JORMUNGANDR_ENCODE_OFFSETS_HPP
+#define _JORMUNGANDR_ENCODE_OFFSETS_HPP
+
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+
+// Writes the bit offsets of the nodes in a graph in the format of the .offsets files of the Java
+// implementation: the gamma coded differences between consecutive offsets, starting from 0.
+class OffsetsEncoder {
+    private:
+        std::ostream& output;
+    public:
+        OffsetsEncoder(std::ostream&);
+        ~OffsetsEncoder() = default;
+
+        auto encode(const std::vector<uint64_t>& offsets) -> void;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef _JORMUNGANDR_ENCODE_PERMUTATION_HPP
+#define _JORMUNGANDR_ENCODE_PERMUTATION_HPP
+
+#include "utility.hpp"
+
+#include <iostream>
+#include <vector>
+#include <concepts>
+
+// Writes a permutation as consecutive big-endian integers of the size of T, which for 32-bit
+// nodes matches the format of BinIO.storeInts as used by the Java implementation.
+template <std::unsigned_integral T>
+class PermutationEncoder {
+    private:
+        std::ostream& output;
+        const std::vector<T>& permutation;
+    public:
+        PermutationEncoder(std::ostream&, const std::vector<T>&);
+        ~PermutationEncoder() = default;
+
+        auto encode() -> void;
+};
+
+template <std::unsigned_integral T>
+PermutationEncoder<T>::PermutationEncoder(std::ostream& output, const std::vector<T>& permutation) :
+    output(output), permutation(permutation) {}
+
+template <std::unsigned_integral T>
+auto PermutationEncoder<T>::encode() -> void {
+    for (auto value : this->permutation) {
+        uint64_t big_endian = byte_swap(uint64_t(value)) >> (bit_size_of<uint64_t>() - bit_size_of<T>());
+        this->output.write(reinterpret_cast<const char*>(&big_endian), sizeof(T));
+    }
+}
+
+#endif
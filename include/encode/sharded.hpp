@@ -0,0 +1,139 @@
+#ifndef _JORMUNGANDR_ENCODE_SHARDED_HPP
+#define _JORMUNGANDR_ENCODE_SHARDED_HPP
+
+#include "encode/webgraph.hpp"
+#include "encode/statistics.hpp"
+#include "encode/property.hpp"
+#include "encode/offsets.hpp"
+#include "encode/chunks.hpp"
+#include "decode/sharded.hpp"
+#include "graph/graph.hpp"
+#include "graph/propertymap.hpp"
+#include "exceptions.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <numeric>
+
+// Splits a graph into shards of consecutive nodes, each of which is written as a separate BVGraph
+// that only references nodes within the shard. The nodes keep their index in the whole graph,
+// the first of which is stored as the basenode property of the shard.
+template <typename T>
+class ShardedEncoder {
+    private:
+        std::filesystem::path basename;
+        EncodingConfig encoding_config;
+        const Graph<T>& graph;
+
+    public:
+        ShardedEncoder(const std::filesystem::path& basename, const EncodingConfig&, const Graph<T>&);
+
+        // Write the shards in parallel, and return the properties of the whole graph
+        auto encode(size_t shards, size_t threads) -> PropertyMap;
+
+    private:
+        auto shard_bounds(size_t shards) const -> std::vector<T>;
+        auto encode_shard(size_t shard, T first, T last) -> EncodingStatistics;
+};
+
+template <typename T>
+ShardedEncoder<T>::ShardedEncoder(const std::filesystem::path& basename, const EncodingConfig& encoding_config,
+                                  const Graph<T>& graph):
+    basename(basename), encoding_config(encoding_config), graph(graph) {
+    // Pick these once for the whole graph, so that all shards share them
+    if (this->encoding_config.needs_golomb_parameters())
+        this->encoding_config = choose_golomb_parameters(encoding_config, graph);
+}
+
+template <typename T>
+auto ShardedEncoder<T>::encode(size_t shards, size_t threads) -> PropertyMap {
+    shards = std::max<size_t>(shards, 1);
+    auto bounds = this->shard_bounds(shards);
+
+    // Shards are about the same size, but still take different times to compress
+    auto stats = std::vector<EncodingStatistics>(shards);
+    auto tasks = std::vector<size_t>(shards + 1);
+    std::iota(tasks.begin(), tasks.end(), 0);
+    parallel_for_tasks(tasks, threads, [&](size_t, size_t first, size_t last) {
+        for (size_t shard = first; shard < last; ++shard)
+            stats[shard] = this->encode_shard(shard, bounds[shard], bounds[shard + 1]);
+    });
+
+    auto total = EncodingStatistics();
+    for (const auto& shard_stats : stats)
+        total += shard_stats;
+
+    auto prop = PropertyMap();
+    this->encoding_config.to_properties(prop);
+    total.to_properties(prop);
+    prop.set("arcs", total.arcs);
+    prop.set("nodes", this->graph.num_nodes());
+    prop.set("shards", shards);
+    bounds.pop_back();
+    prop.set_list("shardbasenodes", bounds);
+
+    return prop;
+}
+
+template <typename T>
+auto ShardedEncoder<T>::shard_bounds(size_t shards) const -> std::vector<T> {
+    // Balance the shards by their number of arcs and nodes, which roughly determines their size
+    size_t n = this->graph.num_nodes();
+    size_t total = 0;
+    for (size_t node = 0; node < n; ++node)
+        total += this->graph.neighbours(node).size() + 1;
+
+    auto bounds = std::vector<T>{0};
+    size_t weight = 0;
+    for (size_t node = 0; node < n && bounds.size() < shards; ++node) {
+        weight += this->graph.neighbours(node).size() + 1;
+        while (bounds.size() < shards && weight * shards >= total * bounds.size())
+            bounds.push_back(node + 1);
+    }
+
+    bounds.resize(shards + 1, n);
+    return bounds;
+}
+
+template <typename T>
+auto ShardedEncoder<T>::encode_shard(size_t shard, T first, T last) -> EncodingStatistics {
+    auto graph_path = shard_path(this->basename, shard, ".graph");
+    auto output = std::ofstream(graph_path, std::ios::binary);
+    if (!output)
+        throw IoException("Failed to create shard ", graph_path);
+
+    auto offsets = std::vector<uint64_t>();
+    auto encoder = WebGraphEncoder<T>(output, this->encoding_config, this->graph);
+    encoder.record_offsets(offsets);
+    encoder.encode_nodes(first, last);
+    offsets.push_back(encoder.position());
+
+    auto prop = encoder.finish();
+    prop.set("basenode", first);
+
+    auto offsets_path = shard_path(this->basename, shard, ".offsets");
+    auto offsets_output = std::ofstream(offsets_path, std::ios::binary);
+    if (!offsets_output)
+        throw IoException("Failed to create shard offsets ", offsets_path);
+    OffsetsEncoder(offsets_output).encode(offsets);
+
+    auto prop_path = shard_path(this->basename, shard, ".properties");
+    auto prop_output = std::ofstream(prop_path);
+    if (!prop_output)
+        throw IoException("Failed to create shard properties ", prop_path);
+    PropertyEncoder(prop_output).encode(prop);
+
+    if (this->encoding_config.is_chunked()) {
+        auto chunks_path = shard_path(this->basename, shard, ".chunks");
+        auto chunks_output = std::ofstream(chunks_path, std::ios::binary);
+        if (!chunks_output)
+            throw IoException("Failed to create shard chunk index ", chunks_path);
+        ChunkIndexEncoder(chunks_output).encode(encoder.chunk_index());
+    }
+
+    return encoder.statistics();
+}
+
+#endif
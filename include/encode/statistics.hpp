@@ -0,0 +1,66 @@
+#ifndef _JORMUNGANDR_ENCODE_STATISTICS_HPP
+#define _JORMUNGANDR_ENCODE_STATISTICS_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <bit>
+
+#include "graph/propertymap.hpp"
+
+// Bits spent on each component of the BVGraph encoding, and how the arcs were represented.
+// These are written along with the other properties, similar to the statistics the Java
+// implementation produces.
+struct EncodingStatistics {
+    // Gap histograms are indexed by floor(log2(gap + 1)), which is also what determines the
+    // length of a gamma or zeta code.
+    using GapHistogram = std::array<uint64_t, 64>;
+
+    uint64_t nodes = 0;
+    uint64_t arcs = 0;
+
+    uint64_t bits_for_outdegrees = 0;
+    uint64_t bits_for_references = 0;
+    uint64_t bits_for_block_counts = 0;
+    uint64_t bits_for_blocks = 0;
+    uint64_t bits_for_intervals = 0;
+    uint64_t bits_for_residuals = 0;
+
+    uint64_t copied_arcs = 0;
+    uint64_t interval_arcs = 0;
+    uint64_t residual_arcs = 0;
+
+    // Number and sum of the coded copy block lengths and residual gaps, from which Golomb
+    // parameters are chosen. These are not written to the properties.
+    uint64_t copy_blocks = 0;
+    uint64_t copy_block_sum = 0;
+    uint64_t residual_gap_sum = 0;
+
+    uint64_t references = 0;
+    uint64_t total_reference_distance = 0;
+    // Number of nodes per length of the reference chain they are part of
+    std::vector<uint64_t> reference_chain_lengths;
+
+    GapHistogram successor_gaps = {};
+    GapHistogram residual_gaps = {};
+
+    inline auto record_reference_chain(uint64_t length) -> void {
+        if (length >= this->reference_chain_lengths.size())
+            this->reference_chain_lengths.resize(length + 1, 0);
+        ++this->reference_chain_lengths[length];
+    }
+
+    static inline auto record_gap(GapHistogram& histogram, uint64_t gap) -> void {
+        ++histogram[std::bit_width(gap + 1) - 1];
+    }
+
+    auto total_bits() const -> uint64_t;
+    auto to_properties(PropertyMap& properties) const -> void;
+    auto operator+=(const EncodingStatistics& other) -> EncodingStatistics&;
+
+    // Recover the statistics written by to_properties. The reference counts are only stored as
+    // averages, so these are approximate. Missing statistics are taken to be zero.
+    static auto from_properties(const PropertyMap& properties) -> EncodingStatistics;
+};
+
+#endif
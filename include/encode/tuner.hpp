@@ -0,0 +1,218 @@
+#ifndef _JORMUNGANDR_ENCODE_TUNER_HPP
+#define _JORMUNGANDR_ENCODE_TUNER_HPP
+
+#include "encode/webgraph.hpp"
+#include "encode/statistics.hpp"
+#include "decode/webgraph.hpp"
+#include "graph/graph.hpp"
+#include "encoding.hpp"
+
+#include <vector>
+#include <utility>
+#include <sstream>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+enum class TuneObjective {
+    SIZE,
+    SPEED
+};
+
+struct TuneOptions {
+    TuneObjective objective = TuneObjective::SIZE;
+
+    // The graph is sampled by encoding sample_ranges evenly spaced ranges of range_size consecutive nodes
+    size_t sample_ranges = 16;
+    size_t range_size = 4096;
+    // The number of times each sample is decoded, of which the fastest is used
+    size_t decode_repetitions = 3;
+    // When optimizing for speed, configurations decoding at most this fraction slower than the
+    // fastest are considered equal, and the smallest of those is picked
+    double speed_tolerance = 0.05;
+
+    uint32_t max_zeta_k = 7;
+    // Also consider Golomb coding the residuals, which suits geometrically distributed gaps
+    bool try_golomb_residuals = true;
+    std::vector<uint32_t> window_sizes = {0, 1, 3, 7, 15};
+    std::vector<uint32_t> max_ref_counts = {1, 3, 6};
+    std::vector<uint32_t> min_interval_sizes = {0, 2, 3, 4};
+};
+
+// Picks the EncodingConfig parameters for a graph by encoding and decoding a sample of it
+// under each candidate configuration.
+template <typename T>
+class EncodingTuner {
+    public:
+        struct Evaluation {
+            EncodingConfig config;
+            EncodingStatistics stats;
+            uint64_t bits;
+            uint64_t decode_ns;
+        };
+
+    private:
+        const Graph<T>& graph;
+        TuneOptions options;
+        std::vector<std::pair<T, T>> ranges;
+
+    public:
+        EncodingTuner(const Graph<T>& graph, const TuneOptions& options = {});
+
+        auto tune(const EncodingConfig& base = {}) -> EncodingConfig;
+        auto evaluate(const EncodingConfig& config) -> Evaluation;
+
+        // The zeta k which minimizes the total length of the gaps in the histogram
+        static auto optimal_zeta_k(const EncodingStatistics::GapHistogram& gaps, uint32_t max_k) -> uint32_t;
+
+    private:
+        auto is_better(const Evaluation& a, const Evaluation& b, uint64_t fastest) const -> bool;
+};
+
+template <typename T>
+EncodingTuner<T>::EncodingTuner(const Graph<T>& graph, const TuneOptions& options):
+    graph(graph), options(options) {
+    size_t nodes = graph.num_nodes();
+    size_t range_size = std::max<size_t>(options.range_size, 1);
+    size_t sample_ranges = std::max<size_t>(options.sample_ranges, 1);
+
+    if (nodes <= sample_ranges * range_size) {
+        this->ranges.emplace_back(0, nodes);
+        return;
+    }
+
+    size_t stride = nodes / sample_ranges;
+    for (size_t i = 0; i < sample_ranges; ++i) {
+        size_t first = i * stride;
+        this->ranges.emplace_back(first, std::min(first + range_size, nodes));
+    }
+}
+
+template <typename T>
+auto EncodingTuner<T>::tune(const EncodingConfig& base) -> EncodingConfig {
+    auto config = base;
+    if (config.needs_golomb_parameters())
+        config = choose_golomb_parameters(config, this->graph);
+    config.zeta_k = optimal_zeta_k(this->evaluate(config).stats.residual_gaps, this->options.max_zeta_k);
+
+    auto evaluations = std::vector<Evaluation>();
+    for (auto window_size : this->options.window_sizes) {
+        for (auto max_ref_count : this->options.max_ref_counts) {
+            for (auto min_interval_size : this->options.min_interval_sizes) {
+                config.window_size = window_size;
+                config.max_ref_count = max_ref_count;
+                config.min_interval_size = min_interval_size;
+                evaluations.push_back(this->evaluate(config));
+            }
+
+            // The maximum reference count is meaningless without a window
+            if (window_size == 0)
+                break;
+        }
+    }
+
+    if (evaluations.empty())
+        return config;
+
+    auto fastest = std::min_element(evaluations.begin(), evaluations.end(), [](const auto& a, const auto& b) {
+        return a.decode_ns < b.decode_ns;
+    })->decode_ns;
+
+    auto best = std::min_element(evaluations.begin(), evaluations.end(), [&](const auto& a, const auto& b) {
+        return this->is_better(a, b, fastest);
+    });
+
+    // Which gaps end up as residuals depends on the other parameters, so pick zeta k again
+    config = best->config;
+    config.zeta_k = optimal_zeta_k(best->stats.residual_gaps, this->options.max_zeta_k);
+    if (config.residual_encoding == Encoding::GOLOMB) {
+        config.residual_golomb_b = golomb_parameter(best->stats.residual_gap_sum, best->stats.residual_arcs);
+    } else if (this->options.try_golomb_residuals) {
+        auto golomb_config = config;
+        golomb_config.residual_encoding = Encoding::GOLOMB;
+        golomb_config.residual_encoding_start = Encoding::GOLOMB;
+        golomb_config.residual_golomb_b = golomb_parameter(best->stats.residual_gap_sum, best->stats.residual_arcs);
+
+        auto current = this->evaluate(config);
+        auto golomb = this->evaluate(golomb_config);
+        if (this->is_better(golomb, current, std::min(fastest, current.decode_ns)))
+            config = golomb_config;
+    }
+    return config;
+}
+
+template <typename T>
+auto EncodingTuner<T>::evaluate(const EncodingConfig& config) -> Evaluation {
+    auto result = Evaluation{config, {}, 0, 0};
+
+    for (auto [first, last] : this->ranges) {
+        auto ss = std::stringstream();
+        {
+            auto encoder = WebGraphEncoder<T>(ss, config, this->graph);
+            encoder.encode_nodes(first, last);
+
+            const auto& stats = encoder.statistics();
+            result.bits += stats.total_bits();
+            result.stats += stats;
+        }
+
+        auto fastest = std::numeric_limits<uint64_t>::max();
+        for (size_t i = 0; i < std::max<size_t>(this->options.decode_repetitions, 1); ++i) {
+            ss.clear();
+            ss.seekg(0);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto decoder = WebGraphDecoder<T>(ss, first, last, config);
+            while (auto node = decoder.next_node()) {
+                continue;
+            }
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            fastest = std::min<uint64_t>(fastest, std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+
+        result.decode_ns += fastest;
+    }
+
+    return result;
+}
+
+template <typename T>
+auto EncodingTuner<T>::optimal_zeta_k(const EncodingStatistics::GapHistogram& gaps, uint32_t max_k) -> uint32_t {
+    uint32_t best_k = 1;
+    auto best_bits = std::numeric_limits<uint64_t>::max();
+
+    for (uint32_t k = 1; k <= std::max<uint32_t>(max_k, 1); ++k) {
+        uint64_t bits = 0;
+        for (uint64_t b = 0; b < gaps.size(); ++b) {
+            // A gap in bucket b is encoded as gap + 1 in [2^b, 2^(b + 1)), for which zeta_k writes h + 1
+            // unary bits followed by a minimal binary code of hk + k bits, or one less in the first bucket.
+            uint64_t h = b / k;
+            uint64_t length = h + 1 + h * k + k - (b == h * k ? 1 : 0);
+            bits += gaps[b] * length;
+        }
+
+        if (bits < best_bits) {
+            best_bits = bits;
+            best_k = k;
+        }
+    }
+
+    return best_k;
+}
+
+template <typename T>
+auto EncodingTuner<T>::is_better(const Evaluation& a, const Evaluation& b, uint64_t fastest) const -> bool {
+    if (this->options.objective == TuneObjective::SPEED) {
+        auto threshold = fastest * (1 + this->options.speed_tolerance);
+        bool a_fast = a.decode_ns <= threshold;
+        bool b_fast = b.decode_ns <= threshold;
+        if (a_fast != b_fast)
+            return a_fast;
+    }
+
+    return a.bits < b.bits;
+}
+
+#endif
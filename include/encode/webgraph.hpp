@@ -2,90 +2,303 @@
 #define _JORMUNGANDR_ENCODE_WEBGRAPH_HPP
 
 #include "encode/bitwriter.hpp"
+#include "encode/statistics.hpp"
+#include "graph/graph.hpp"
 #include "graph/propertymap.hpp"
 #include "encoding.hpp"
 #include "exceptions.hpp"
+#include "instrumentation.hpp"
+#include "progress.hpp"
 
 #include <span>
+#include <vector>
 #include <deque>
 #include <optional>
 #include <algorithm>
+#include <numeric>
+#include <ostream>
 
 template <typename T>
 class WebGraphEncoder {
     private:
         BitWriter output;
         EncodingConfig encoding_config;
-        const Graph<T>& graph;
+        // When no graph is given, nodes are pushed one by one and the window keeps a copy of their lists
+        const Graph<T>* graph;
+        std::vector<std::vector<T>> window_lists;
+        // First node of the reference window, which for chunked graphs is the start of the current chunk
+        T first_node;
+        T next_node;
         std::deque<T> window_ref_counts;
-
+        // Bit offset in the graph of the start of the output, and of the current chunk
+        uint64_t output_start;
+        uint64_t chunk_start;
+        std::vector<ChunkEntry> chunks;
+        std::vector<uint64_t>* offsets;
+        // Bottom-k sketches of the successor lists in the window, indexed by node modulo window size + 1
+        std::vector<std::vector<uint64_t>> window_sketches;
+        std::vector<uint64_t> node_sketch;
+        std::vector<T> candidates;
+        std::vector<std::pair<double, T>> candidate_estimates;
+        EncodingStatistics stats;
+        ProgressReporter* progress = nullptr;
+        // Reported as the total when no graph is given
+        T progress_total_nodes = 0;
+
+        auto begin_chunk(T node) -> void;
+        auto window_neighbours(T node) const -> std::span<const T>;
         auto find_most_overlapping(T node, const std::span<const T>&) -> std::optional<T>;
+        auto preselect_candidates(T node, T start, const std::span<const T>&) -> void;
+        auto push_window(T node, const std::span<const T>&, T ref_count) -> void;
+        auto compute_sketch(const std::span<const T>&, std::vector<uint64_t>&) -> void;
+        auto estimate_overlap(const std::vector<uint64_t>&, size_t, const std::vector<uint64_t>&, size_t) -> double;
         auto find_copy_blocks(const std::span<const T>&, T, std::vector<T>&) -> std::vector<size_t>;
 
         auto encode_node(T, const std::span<const T>&) -> void;
         auto encode_reference_list(T, const std::span<const T>&) -> std::vector<T>;
         auto encode_remaining(T, const std::vector<T>&) -> void;
-        auto encode_value(auto, Encoding) -> void;
+        auto encode_value(auto, Encoding, uint32_t golomb_b = 0) -> void;
         auto encode_interval_list(T index, std::vector<T>& nodes) -> void;
-        auto encode_maybe_negative(T value, T index, Encoding encoding) -> void;
+        // Returns the coded value
+        auto encode_maybe_negative(T value, T index, Encoding encoding, uint32_t golomb_b = 0) -> uint64_t;
+        auto record_gaps(T, const std::span<const T>&, EncodingStatistics::GapHistogram&) -> void;
     public:
         WebGraphEncoder(std::ostream&, const EncodingConfig&, const Graph<T>&);
+        // Construct an encoder to which the successor lists are pushed in node order
+        WebGraphEncoder(std::ostream&, const EncodingConfig&);
 
         auto encode() -> PropertyMap;
+        // Encode the nodes in [first, last), starting with an empty reference window at first.
+        auto encode_nodes(T first, T last) -> void;
+        // Encode the successors of the next node.
+        auto push_node(std::span<const T> neighbours) -> void;
+        // Flush the output, and return the properties of the nodes encoded so far.
+        auto finish() -> PropertyMap;
+        // Report progress to progress whenever another 64 KiB has been written. The encoder must not
+        // be moved afterwards. total_nodes is the number of nodes that will be pushed, if known.
+        auto set_progress(ProgressReporter& progress, T total_nodes = 0) -> void;
+
+        // Continue an existing encoding at node, which ends at bit_position. The output must be
+        // positioned at the byte containing that bit, of which the leading bits are partial_byte.
+        auto resume(T node, uint64_t bit_position, uint8_t partial_byte) -> void;
+        // Restore a node of the reference window of a resumed encoding, oldest first.
+        auto restore_window_node(T index, std::span<const T> neighbours, T ref_count) -> void;
+        // Restore the chunk of a resumed chunked encoding, after restoring the window.
+        auto restore_chunk(T first_node, uint64_t start_position) -> void;
+
+        // Bit offset in the graph of the end of the encoded nodes
+        inline auto position() const -> uint64_t {
+            return this->output_start + this->output.written_bits();
+        }
+
+        // Append the bit offset of every node pushed from now on to offsets
+        inline auto record_offsets(std::vector<uint64_t>& offsets) -> void {
+            this->offsets = &offsets;
+        }
+
+        // The chunks started by this encoder
+        inline auto chunk_index() const -> const std::vector<ChunkEntry>& {
+            return this->chunks;
+        }
+
+        inline auto statistics() const -> const EncodingStatistics& {
+            return this->stats;
+        }
 };
 
+// Fill in the missing Golomb parameters of config. Which values are coded does not depend on
+// the codes used, so these are found by encoding the graph once with gamma codes instead.
+template <typename T>
+auto choose_golomb_parameters(const EncodingConfig& config, const Graph<T>& graph) -> EncodingConfig {
+    auto sample_config = config;
+    for (auto* encoding : {&sample_config.outdegree_encoding, &sample_config.copy_block_encoding,
+                           &sample_config.residual_encoding, &sample_config.residual_encoding_start}) {
+        if (*encoding == Encoding::GOLOMB)
+            *encoding = Encoding::GAMMA;
+    }
+
+    // The encoded graph itself is discarded
+    auto discard = std::ostream(nullptr);
+    auto encoder = WebGraphEncoder<T>(discard, sample_config, graph);
+    encoder.encode_nodes(0, graph.num_nodes());
+    const auto& stats = encoder.statistics();
+
+    auto result = config;
+    if (result.outdegree_golomb_b == 0)
+        result.outdegree_golomb_b = golomb_parameter(stats.arcs, stats.nodes);
+    if (result.copy_block_golomb_b == 0)
+        result.copy_block_golomb_b = golomb_parameter(stats.copy_block_sum, stats.copy_blocks);
+    if (result.residual_golomb_b == 0)
+        result.residual_golomb_b = golomb_parameter(stats.residual_gap_sum, stats.residual_arcs);
+    return result;
+}
+
 template <typename T>
 WebGraphEncoder<T>::WebGraphEncoder(std::ostream& output, const EncodingConfig& encoding_config,
                                     const Graph<T>& graph) :
-        output(output), encoding_config(encoding_config), graph(graph) {}
+        output(output), encoding_config(encoding_config), graph(&graph), first_node(0), next_node(0),
+        output_start(0), chunk_start(0), offsets(nullptr) {
+    if (this->encoding_config.needs_golomb_parameters())
+        this->encoding_config = choose_golomb_parameters(encoding_config, graph);
+    if (this->encoding_config.sketch_candidates > 0)
+        this->window_sketches.resize(this->encoding_config.window_size + 1);
+}
+
+template <typename T>
+WebGraphEncoder<T>::WebGraphEncoder(std::ostream& output, const EncodingConfig& encoding_config) :
+        output(output), encoding_config(encoding_config), graph(nullptr),
+        window_lists(encoding_config.window_size + 1), first_node(0), next_node(0),
+        output_start(0), chunk_start(0), offsets(nullptr) {
+    if (this->encoding_config.sketch_candidates > 0)
+        this->window_sketches.resize(this->encoding_config.window_size + 1);
+}
 
 template <typename T>
 auto WebGraphEncoder<T>::encode() -> PropertyMap {
+    this->encode_nodes(0, this->graph->num_nodes());
+    return this->finish();
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::finish() -> PropertyMap {
     auto prop = PropertyMap();
     this->encoding_config.to_properties(prop);
 
-    size_t edges = 0;
-    size_t nodes = this->graph.num_nodes();
-    this->graph.for_each([&](T node, std::span<const T> neighbours) {
-        this->encode_node(node, neighbours);
-
-        edges += neighbours.size();
-    });
     this->output.flush();
+    if (this->progress)
+        this->progress->finish(this->stats.nodes, this->graph ? this->graph->num_nodes() : this->progress_total_nodes, this->stats.arcs,
+                               this->output.written_bits() / bit_size_of<uint8_t>());
+
+    this->stats.to_properties(prop);
 
-    prop.set("arcs", edges);
-    prop.set("nodes", nodes);
+    prop.set("arcs", this->stats.arcs);
+    prop.set("nodes", this->stats.nodes);
     prop.set("graphclass", "it.unimi.dsi.webgraph.BVGraph");
     prop.set("version", 0);
 
     return prop;
 }
 
+template <typename T>
+auto WebGraphEncoder<T>::set_progress(ProgressReporter& progress, T total_nodes) -> void {
+    this->progress = &progress;
+    this->progress_total_nodes = total_nodes;
+    this->output.on_progress([this]() {
+        this->progress->update(this->stats.nodes, this->graph ? this->graph->num_nodes() : this->progress_total_nodes, this->stats.arcs,
+                               this->output.written_bits() / bit_size_of<uint8_t>());
+    });
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::encode_nodes(T first, T last) -> void {
+    this->first_node = first;
+    this->next_node = first;
+    this->window_ref_counts.clear();
+
+    for (T node = first; node < last; ++node)
+        this->push_node(this->graph->neighbours(node));
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::push_node(std::span<const T> neighbours) -> void {
+    T node = this->next_node++;
+    if (this->encoding_config.is_chunked() && (node == this->first_node ||
+        this->encoding_config.starts_chunk(node - this->first_node, this->position() - this->chunk_start))) {
+        this->begin_chunk(node);
+    }
+
+    if (this->offsets)
+        this->offsets->push_back(this->position());
+    this->encode_node(node, neighbours);
+
+    if (!this->graph && this->encoding_config.window_size > 0) {
+        auto& list = this->window_lists[node % this->window_lists.size()];
+        list.assign(neighbours.begin(), neighbours.end());
+    }
+
+    ++this->stats.nodes;
+    this->stats.arcs += neighbours.size();
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::resume(T node, uint64_t bit_position, uint8_t partial_byte) -> void {
+    size_t partial_bits = bit_position % bit_size_of<uint8_t>();
+    this->output_start = bit_position - partial_bits;
+    if (partial_bits > 0)
+        this->output.write_bits(partial_byte >> (bit_size_of<uint8_t>() - partial_bits), partial_bits);
+
+    this->first_node = node;
+    this->next_node = node;
+    this->window_ref_counts.clear();
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::restore_window_node(T index, std::span<const T> neighbours, T ref_count) -> void {
+    if (this->window_ref_counts.empty())
+        this->first_node = index;
+    this->next_node = index + 1;
+
+    if (this->encoding_config.window_size == 0)
+        return;
+
+    if (!this->graph) {
+        auto& list = this->window_lists[index % this->window_lists.size()];
+        list.assign(neighbours.begin(), neighbours.end());
+    }
+
+    if (!this->window_sketches.empty() && !neighbours.empty())
+        this->compute_sketch(neighbours, this->node_sketch);
+    this->push_window(index, neighbours, ref_count);
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::restore_chunk(T first_node, uint64_t start_position) -> void {
+    this->first_node = first_node;
+    this->chunk_start = start_position;
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::begin_chunk(T node) -> void {
+    this->output.align();
+    this->first_node = node;
+    this->window_ref_counts.clear();
+    this->chunk_start = this->position();
+    this->chunks.push_back({node, this->chunk_start / bit_size_of<uint8_t>()});
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::window_neighbours(T node) const -> std::span<const T> {
+    if (this->graph)
+        return this->graph->neighbours(node);
+    return this->window_lists[node % this->window_lists.size()];
+}
+
 template <typename T>
 auto WebGraphEncoder<T>::find_most_overlapping(T node, const std::span<const T>& neighbours) -> std::optional<T> {
+    JORMUNGANDR_TIME(ENCODER_REFERENCE_SEARCH);
     auto best_node = std::optional<T>(std::nullopt);
     auto best_score = size_t{0};
 
-    auto start = this->encoding_config.window_size == 0 || node < this->encoding_config.window_size ?
-        0 : node - this->encoding_config.window_size;
+    auto start = this->encoding_config.window_size == 0 || node - this->first_node < this->encoding_config.window_size ?
+        this->first_node : node - this->encoding_config.window_size;
 
-    for (auto i = start; i < node; ++i) {
+    this->preselect_candidates(node, start, neighbours);
+    JORMUNGANDR_COUNT(ENCODER_INTERSECTIONS, this->candidates.size());
+    for (auto i : this->candidates) {
+        JORMUNGANDR_COUNT(ENCODER_INTERSECTED_ARCS, this->window_neighbours(i).size());
         size_t matches = 0;
         size_t span_offset = 0;
 
-        if(this->window_ref_counts[i - start] >= this->encoding_config.max_ref_count)
-            continue;
-
-        this->graph.for_each_neighbour(i, [&](T neighbour) {
+        for (auto neighbour : this->window_neighbours(i)) {
             while(span_offset < neighbours.size() && neighbours[span_offset] < neighbour)
                 ++span_offset;
 
             if(span_offset >= neighbours.size())
-                return;
+                break;
 
             if(neighbours[span_offset] == neighbour)
                 ++matches;
-        });
+        }
 
         if(matches > best_score) {
             best_score = matches;
@@ -93,13 +306,120 @@ auto WebGraphEncoder<T>::find_most_overlapping(T node, const std::span<const T>&
         }
     }
 
-    if(!best_node)
-        this->window_ref_counts.push_back(0);
-    else
-        this->window_ref_counts.push_back(this->window_ref_counts[best_node.value() - start] + 1);
+    this->push_window(node, neighbours, best_node ? this->window_ref_counts[best_node.value() - start] + 1 : 0);
+    return best_node;
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::preselect_candidates(T node, T start, const std::span<const T>& neighbours) -> void {
+    auto& candidates = this->candidates;
+    candidates.clear();
+    size_t candidate_arcs = 0;
+    for (auto i = start; i < node; ++i) {
+        if(this->window_ref_counts[i - start] < this->encoding_config.max_ref_count) {
+            candidates.push_back(i);
+            candidate_arcs += this->window_neighbours(i).size();
+        }
+    }
+    JORMUNGANDR_COUNT(ENCODER_WINDOW_CANDIDATES, candidates.size());
+
+    if (this->window_sketches.empty())
+        return;
+
+    this->compute_sketch(neighbours, this->node_sketch);
+
+    // Comparing sketches costs about as much as intersecting lists of twice the sketch size,
+    // so short lists are cheaper to intersect directly.
+    auto max_candidates = this->encoding_config.sketch_candidates;
+    auto intersection_cost = candidate_arcs + candidates.size() * neighbours.size();
+    auto sketch_cost = candidates.size() * 2 * this->encoding_config.sketch_size;
+    if (candidates.size() <= max_candidates || intersection_cost <= sketch_cost)
+        return;
+
+    JORMUNGANDR_COUNT(ENCODER_SKETCH_COMPARISONS, candidates.size());
+    auto& estimates = this->candidate_estimates;
+    estimates.clear();
+    for (auto i : candidates) {
+        const auto& other = this->window_sketches[i % this->window_sketches.size()];
+        auto overlap = this->estimate_overlap(this->node_sketch, neighbours.size(), other, this->window_neighbours(i).size());
+        estimates.emplace_back(overlap, i);
+    }
+
+    // Prefer the closest candidate when estimates are equal, as it is cheaper to reference
+    std::partial_sort(estimates.begin(), estimates.begin() + max_candidates, estimates.end(),
+                      [](const auto& a, const auto& b) {
+        return a.first > b.first || (a.first == b.first && a.second > b.second);
+    });
+
+    candidates.clear();
+    for (size_t i = 0; i < max_candidates; ++i)
+        candidates.push_back(estimates[i].second);
+    // Visit the candidates in node order, so that ties are broken in the same way as without sketches
+    std::sort(candidates.begin(), candidates.end());
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::push_window(T node, const std::span<const T>& neighbours, T ref_count) -> void {
+    this->window_ref_counts.push_back(ref_count);
     if(this->window_ref_counts.size() > this->encoding_config.window_size)
         this->window_ref_counts.pop_front();
-    return best_node;
+
+    if (this->window_sketches.empty())
+        return;
+
+    // The sketch of a non-empty list was already computed while looking for its reference
+    auto& sketch = this->window_sketches[node % this->window_sketches.size()];
+    if (neighbours.empty())
+        sketch.clear();
+    else
+        std::swap(sketch, this->node_sketch);
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::compute_sketch(const std::span<const T>& neighbours, std::vector<uint64_t>& sketch) -> void {
+    sketch.clear();
+    for (auto neighbour : neighbours) {
+        // splitmix64 finalizer
+        uint64_t h = uint64_t(neighbour) + 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        sketch.push_back(h ^ (h >> 31));
+    }
+
+    size_t k = std::min<size_t>(this->encoding_config.sketch_size, sketch.size());
+    std::nth_element(sketch.begin(), sketch.begin() + k, sketch.end());
+    sketch.resize(k);
+    std::sort(sketch.begin(), sketch.end());
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::estimate_overlap(const std::vector<uint64_t>& a, size_t a_size,
+                                          const std::vector<uint64_t>& b, size_t b_size) -> double {
+    // Estimate the Jaccard index from the smallest hashes of the union, of which
+    // the intersection size then follows as J / (1 + J) * (|A| + |B|).
+    size_t k = std::max(a.size(), b.size());
+    size_t i = 0;
+    size_t j = 0;
+    size_t taken = 0;
+    size_t common = 0;
+    while (taken < k && i < a.size() && j < b.size()) {
+        if (a[i] == b[j]) {
+            ++common;
+            ++i;
+            ++j;
+        } else if (a[i] < b[j]) {
+            ++i;
+        } else {
+            ++j;
+        }
+        ++taken;
+    }
+
+    if (taken == 0)
+        return 0;
+
+    double jaccard = double(common) / std::max(taken, k);
+    return jaccard / (1 + jaccard) * (a_size + b_size);
 }
 
 template <typename T>
@@ -110,7 +430,7 @@ auto WebGraphEncoder<T>::find_copy_blocks(const std::span<const T>& neighbours,
 
     size_t vec_idx = 0;
     size_t current_size = 0;
-    this->graph.for_each_neighbour(ref_node, [&](T ref_neighbour) {
+    for (auto ref_neighbour : this->window_neighbours(ref_node)) {
         while(vec_idx < neighbours.size() && neighbours[vec_idx] < ref_neighbour)
             ++vec_idx;
 
@@ -119,7 +439,7 @@ auto WebGraphEncoder<T>::find_copy_blocks(const std::span<const T>& neighbours,
                 copy = false;
                 result.push_back(current_size);
             }
-            return;
+            break;
         }
 
         if((neighbours[vec_idx] == ref_neighbour) != copy) {
@@ -132,16 +452,25 @@ auto WebGraphEncoder<T>::find_copy_blocks(const std::span<const T>& neighbours,
             copied.push_back(ref_neighbour);
 
         ++current_size;
-    });
+    }
 
     return result;
 }
 
 template <typename T>
 auto WebGraphEncoder<T>::encode_node(T node, const std::span<const T>& neighbours) -> void {
-    this->encode_value(neighbours.size(), this->encoding_config.outdegree_encoding);
-    if(neighbours.size() == 0)
+    JORMUNGANDR_COUNT(ENCODER_NODES, 1);
+    auto start = this->output.written_bits();
+    this->encode_value(neighbours.size(), this->encoding_config.outdegree_encoding,
+                       this->encoding_config.outdegree_golomb_b);
+    this->stats.bits_for_outdegrees += this->output.written_bits() - start;
+    if(neighbours.size() == 0) {
+        if (this->encoding_config.window_size > 0)
+            this->push_window(node, neighbours, 0);
         return;
+    }
+
+    this->record_gaps(node, neighbours, this->stats.successor_gaps);
 
     auto remaining = this->encoding_config.window_size > 0 ?
         this->encode_reference_list(node, neighbours) :
@@ -155,17 +484,28 @@ auto WebGraphEncoder<T>::encode_node(T node, const std::span<const T>& neighbour
 template <typename T>
 auto WebGraphEncoder<T>::encode_reference_list(T node, const std::span<const T>& neighbours) -> std::vector<T> {
     auto maybe_reference = this->find_most_overlapping(node, neighbours);
+    this->stats.record_reference_chain(this->window_ref_counts.back());
+
+    auto start = this->output.written_bits();
     if (!maybe_reference.has_value()) {
         this->encode_value(0, this->encoding_config.reference_encoding);
+        this->stats.bits_for_references += this->output.written_bits() - start;
         return std::vector<T>(neighbours.begin(), neighbours.end());
     }
 
     auto reference = *maybe_reference;
     this->encode_value(node - reference, this->encoding_config.reference_encoding);
+    this->stats.bits_for_references += this->output.written_bits() - start;
+    ++this->stats.references;
+    this->stats.total_reference_distance += node - reference;
 
     auto copied = std::vector<T>();
     auto blocks = this->find_copy_blocks(neighbours, reference, copied);
+    this->stats.copied_arcs += copied.size();
+
+    start = this->output.written_bits();
     this->encode_value(blocks.size(), this->encoding_config.block_count_encoding);
+    this->stats.bits_for_block_counts += this->output.written_bits() - start;
 
     auto result = std::vector<T>();
     size_t copied_idx = 0;
@@ -179,9 +519,14 @@ auto WebGraphEncoder<T>::encode_reference_list(T node, const std::span<const T>&
     if (blocks.size() == 0)
         return result;
 
-    this->encode_value(blocks[0], this->encoding_config.copy_block_encoding);
+    start = this->output.written_bits();
+    auto block_golomb_b = this->encoding_config.copy_block_golomb_b;
+    this->encode_value(blocks[0], this->encoding_config.copy_block_encoding, block_golomb_b);
     for(size_t i = 1; i < blocks.size(); ++i)
-        this->encode_value(blocks[i] - 1, this->encoding_config.copy_block_encoding);
+        this->encode_value(blocks[i] - 1, this->encoding_config.copy_block_encoding, block_golomb_b);
+    this->stats.bits_for_blocks += this->output.written_bits() - start;
+    this->stats.copy_blocks += blocks.size();
+    this->stats.copy_block_sum += std::accumulate(blocks.begin(), blocks.end(), uint64_t(0)) - (blocks.size() - 1);
 
     return result;
 }
@@ -200,12 +545,15 @@ auto WebGraphEncoder<T>::encode_interval_list(T index, std::vector<T>& nodes) ->
         size_t length = interval_length(nodes, i);
         if (length >= this->encoding_config.min_interval_size) {
             ++intervals;
+            this->stats.interval_arcs += length;
         }
         i += length;
     }
 
+    auto start = this->output.written_bits();
     this->encode_value(intervals, this->encoding_config.interval_count_encoding);
     if (intervals == 0) {
+        this->stats.bits_for_intervals += this->output.written_bits() - start;
         return;
     }
 
@@ -233,10 +581,11 @@ auto WebGraphEncoder<T>::encode_interval_list(T index, std::vector<T>& nodes) ->
         prev = node;
         prev_len = length;
     }
+    this->stats.bits_for_intervals += this->output.written_bits() - start;
 
     for (size_t i = 0; i < nodes.size();) {
         size_t length = interval_length(nodes, i);
-        if (length < 2) {
+        if (length < this->encoding_config.min_interval_size) {
             i += length;
             continue;
         }
@@ -250,26 +599,44 @@ auto WebGraphEncoder<T>::encode_remaining(T node, const std::vector<T>& nodes) -
     if(nodes.size() == 0)
         return;
 
-    this->encode_maybe_negative(nodes[0], node, this->encoding_config.residual_encoding_start);
+    this->stats.residual_arcs += nodes.size();
+    this->record_gaps(node, nodes, this->stats.residual_gaps);
+
+    auto start = this->output.written_bits();
+    auto golomb_b = this->encoding_config.residual_golomb_b;
+    uint64_t gap_sum = this->encode_maybe_negative(nodes[0], node, this->encoding_config.residual_encoding_start, golomb_b);
 
     auto prev_node = nodes[0];
     for(size_t i = 1; i < nodes.size(); ++i) {
-        this->encode_value(nodes[i] - prev_node - 1, this->encoding_config.residual_encoding);
+        this->encode_value(nodes[i] - prev_node - 1, this->encoding_config.residual_encoding, golomb_b);
+        gap_sum += nodes[i] - prev_node - 1;
         prev_node = nodes[i];
     }
+    this->stats.bits_for_residuals += this->output.written_bits() - start;
+    this->stats.residual_gap_sum += gap_sum;
 }
 
 template <typename T>
-auto WebGraphEncoder<T>::encode_maybe_negative(T value, T index, Encoding encoding) -> void {
-    if (value >= index) {
-        this->encode_value((value - index) * 2, encoding);
-    } else {
-        this->encode_value(2 * (index - value) - 1, encoding);
-    }
+auto WebGraphEncoder<T>::record_gaps(T node, const std::span<const T>& nodes,
+                                     EncodingStatistics::GapHistogram& histogram) -> void {
+    // The first gap is relative to the node itself, and is encoded as in encode_maybe_negative
+    EncodingStatistics::record_gap(histogram, nodes[0] >= node ?
+        uint64_t(nodes[0] - node) * 2 :
+        uint64_t(node - nodes[0]) * 2 - 1);
+
+    for(size_t i = 1; i < nodes.size(); ++i)
+        EncodingStatistics::record_gap(histogram, nodes[i] - nodes[i - 1] - 1);
+}
+
+template <typename T>
+auto WebGraphEncoder<T>::encode_maybe_negative(T value, T index, Encoding encoding, uint32_t golomb_b) -> uint64_t {
+    uint64_t coded = value >= index ? uint64_t(value - index) * 2 : uint64_t(index - value) * 2 - 1;
+    this->encode_value(coded, encoding, golomb_b);
+    return coded;
 }
 
 template <typename T>
-auto WebGraphEncoder<T>::encode_value(auto value, Encoding encoding) -> void {
+auto WebGraphEncoder<T>::encode_value(auto value, Encoding encoding, uint32_t golomb_b) -> void {
     switch(encoding) {
         case Encoding::DELTA:
             return this->output.write_delta(value);
@@ -281,6 +648,12 @@ auto WebGraphEncoder<T>::encode_value(auto value, Encoding encoding) -> void {
             return this->output.write_zeta(value, this->encoding_config.zeta_k);
         case Encoding::PRED_SIZE:
             return this->output.write_pred_size(value, this->encoding_config.pred_size);
+        case Encoding::GOLOMB:
+            if (golomb_b == 0)
+                throw EncodingException("Golomb coding requires a parameter");
+            return this->output.write_golomb(value, golomb_b);
+        case Encoding::NIBBLE:
+            return this->output.write_nibble(value);
         default:
             throw EncodingException("Invalid encoding");
     }
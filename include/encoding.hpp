@@ -2,6 +2,7 @@
 #define _JORMUNGANDR_ENCODING_HPP
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include "graph/propertymap.hpp"
 #include "exceptions.hpp"
@@ -11,7 +12,23 @@ enum class Encoding {
     GAMMA,
     UNARY,
     ZETA,
-    PRED_SIZE
+    PRED_SIZE,
+    GOLOMB,
+    NIBBLE
+};
+
+auto encoding_from_string(std::string_view name) -> Encoding;
+auto encoding_to_string(Encoding encoding) -> std::string;
+
+// The Golomb parameter which minimizes the expected code length of count values adding up to
+// sum, assuming they are geometrically distributed
+auto golomb_parameter(uint64_t sum, uint64_t count) -> uint32_t;
+
+// Start of a chunk of a chunked graph, see EncodingConfig::chunk_nodes
+struct ChunkEntry {
+    uint64_t first_node;
+    // Offset in bytes in the graph file
+    uint64_t offset;
 };
 
 struct EncodingConfig {
@@ -34,6 +51,39 @@ struct EncodingConfig {
     uint32_t max_ref_count = 3;
     uint32_t pred_size = 4;
 
+    // Parameters of the outdegrees, copy blocks and residuals when these use Encoding::GOLOMB.
+    // When zero, an encoder given the whole graph picks them from the data.
+    uint32_t outdegree_golomb_b = 0;
+    uint32_t copy_block_golomb_b = 0;
+    uint32_t residual_golomb_b = 0;
+
+    // Encoder only: when non-zero, only the sketch_candidates entries of the window with the most
+    // similar bottom-k sketch of sketch_size hashes are fully intersected to find a reference.
+    uint32_t sketch_candidates = 0;
+    uint32_t sketch_size = 16;
+
+    // When non-zero, the reference window is reset and the output byte aligned at the first node
+    // after every chunk_nodes nodes, or after the chunk reached chunk_bytes bytes. Every chunk can
+    // then be decoded on its own.
+    uint32_t chunk_nodes = 0;
+    uint32_t chunk_bytes = 0;
+
+    inline auto is_chunked() const -> bool {
+        return this->chunk_nodes > 0 || this->chunk_bytes > 0;
+    }
+
+    // Whether the node following a chunk of the given number of nodes and bits starts a new chunk
+    inline auto starts_chunk(uint64_t nodes, uint64_t bits) const -> bool {
+        return (this->chunk_nodes > 0 && nodes >= this->chunk_nodes) ||
+            (this->chunk_bytes > 0 && bits >= uint64_t(this->chunk_bytes) * 8);
+    }
+
+    inline auto needs_golomb_parameters() const -> bool {
+        return (this->outdegree_encoding == Encoding::GOLOMB && this->outdegree_golomb_b == 0) ||
+            (this->copy_block_encoding == Encoding::GOLOMB && this->copy_block_golomb_b == 0) ||
+            (this->residual_encoding == Encoding::GOLOMB && this->residual_golomb_b == 0);
+    }
+
     static auto from_properties(const PropertyMap& properties) -> EncodingConfig;
     auto to_properties(PropertyMap& properties) -> void;
 };
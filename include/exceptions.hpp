@@ -40,4 +40,11 @@ class EncodingException : public Exception {
         virtual ~EncodingException() = default;
 };
 
+class IoException : public Exception {
+    public:
+        template <typename... Args>
+        IoException(const Args&... args) : Exception(args...) {}
+        virtual ~IoException() = default;
+};
+
 #endif
@@ -0,0 +1,59 @@
+#ifndef _JORMUNGANDR_GRAPH_BITMAP_HPP
+#define _JORMUNGANDR_GRAPH_BITMAP_HPP
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+// A fixed size bitmap that answers rank and select queries once build_index() has been called.
+// The index stores the number of ones before every block of 512 bits, which adds an eighth to the
+// size of the bitmap.
+class RankSelectBitmap {
+    private:
+        constexpr const static size_t block_words = 8;
+
+        std::vector<uint64_t> words;
+        // The number of ones before every block, followed by the total
+        std::vector<uint64_t> block_ranks;
+        size_t bits;
+
+    public:
+        RankSelectBitmap(): bits(0) {}
+        explicit RankSelectBitmap(size_t size);
+
+        // Compute the rank index, which must be done again after the bitmap is changed
+        auto build_index() -> void;
+        // The position of the one with the given rank, of which there must be more than rank
+        auto select(uint64_t rank) const -> size_t;
+
+        inline auto set(size_t i) -> void {
+            this->words[i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        inline auto test(size_t i) const -> bool {
+            return (this->words[i / 64] >> (i % 64)) & 1;
+        }
+
+        // The number of ones before position i
+        inline auto rank(size_t i) const -> uint64_t {
+            size_t word = i / 64;
+            size_t block = word / block_words;
+            uint64_t rank = this->block_ranks[block];
+            for (size_t w = block * block_words; w < word; ++w)
+                rank += std::popcount(this->words[w]);
+            if (i % 64 != 0)
+                rank += std::popcount(this->words[word] << (64 - i % 64));
+            return rank;
+        }
+
+        inline auto count() const -> uint64_t {
+            return this->block_ranks.back();
+        }
+
+        inline auto size() const -> size_t {
+            return this->bits;
+        }
+};
+
+#endif
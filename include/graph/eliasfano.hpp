@@ -0,0 +1,479 @@
+#ifndef _JORMUNGANDR_GRAPH_ELIASFANO_HPP
+#define _JORMUNGANDR_GRAPH_ELIASFANO_HPP
+
+#include "graph/graph.hpp"
+#include "exceptions.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <iterator>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+
+// Quasi-succinct representation of a graph, similar to the EFGraph of the Java implementation.
+// Every successor list is stored as an Elias-Fano sequence, which gives constant time access to
+// the i-th successor and fast skipping to the first successor at least some node.
+//
+// Bits are stored least significant first in 64-bit words. A sequence of n values below universe
+// u uses l = floor(log2(u / n)) low bits per value, stored consecutively, followed by the upper
+// bits in unary as a bit vector of n + (u >> l) + 1 bits: a one for every value, and a zero
+// after the values in every bucket of equal upper bits. Before these are skip pointers to every
+// quantum-th one and zero in the upper bits.
+namespace detail {
+    inline auto read_word_bits(const uint64_t* words, uint64_t position, size_t width) -> uint64_t {
+        if (width == 0)
+            return 0;
+
+        size_t shift = position % 64;
+        uint64_t value = words[position / 64] >> shift;
+        if (shift + width > 64)
+            value |= words[position / 64 + 1] << (64 - shift);
+        return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+    }
+
+    // Gamma code of value + 1, of which the unary part is written as zeros
+    inline auto read_word_gamma(const uint64_t* words, uint64_t& position) -> uint64_t {
+        size_t zeros = std::countr_zero(read_word_bits(words, position, 64));
+        position += zeros + 1;
+        uint64_t value = read_word_bits(words, position, zeros);
+        position += zeros;
+        return ((uint64_t(1) << zeros) | value) - 1;
+    }
+
+    class WordBitWriter {
+        private:
+            std::vector<uint64_t> words;
+            uint64_t bits = 0;
+
+        public:
+            inline auto write(uint64_t value, size_t width) -> void {
+                if (width == 0)
+                    return;
+
+                size_t shift = this->bits % 64;
+                if (shift == 0)
+                    this->words.push_back(0);
+                this->words.back() |= value << shift;
+                if (shift + width > 64)
+                    this->words.push_back(value >> (64 - shift));
+                this->bits += width;
+            }
+
+            inline auto write_gamma(uint64_t value) -> void {
+                ++value;
+                size_t width = std::bit_width(value) - 1;
+                this->write(0, width);
+                this->write(1, 1);
+                this->write(value & ~(uint64_t(1) << width), width);
+            }
+
+            inline auto set(uint64_t position) -> void {
+                this->words[position / 64] |= uint64_t(1) << (position % 64);
+            }
+
+            inline auto skip(uint64_t n) -> void {
+                this->bits += n;
+                this->words.resize((this->bits + 63) / 64, 0);
+            }
+
+            inline auto align() -> void {
+                this->skip((64 - this->bits % 64) % 64);
+            }
+
+            inline auto size() const -> uint64_t {
+                return this->bits;
+            }
+
+            // Take the words, followed by a zero word so that reads may always look one word ahead
+            inline auto release() -> std::vector<uint64_t> {
+                this->words.push_back(0);
+                return std::move(this->words);
+            }
+    };
+
+    struct EliasFanoLayout {
+        size_t size;
+        uint64_t universe;
+        size_t low_bits;
+        size_t pointer_width;
+        size_t one_pointers;
+        size_t zero_pointers;
+        uint64_t upper_bits;
+
+        EliasFanoLayout(size_t size, uint64_t universe, size_t quantum):
+            size(size), universe(universe) {
+            this->low_bits = size == 0 || universe <= size ? 0 : std::bit_width(universe / size) - 1;
+            this->upper_bits = size + (universe >> this->low_bits) + 1;
+            this->pointer_width = std::bit_width(this->upper_bits);
+            this->one_pointers = size == 0 ? 0 : (size - 1) / quantum;
+            this->zero_pointers = (universe >> this->low_bits) / quantum;
+        }
+
+        inline auto total_bits() const -> uint64_t {
+            return (this->one_pointers + this->zero_pointers) * this->pointer_width +
+                this->size * this->low_bits + this->upper_bits;
+        }
+    };
+
+    // Write a non-decreasing sequence of values below universe
+    template <typename V>
+    auto write_elias_fano(WordBitWriter& writer, std::span<const V> values, uint64_t universe, size_t quantum) -> void {
+        auto layout = EliasFanoLayout(values.size(), universe, quantum);
+        auto high = [&](size_t i) {
+            return uint64_t(values[i]) >> layout.low_bits;
+        };
+
+        // One i is at position high(i) + i, and the zero closing bucket b at b plus the number of
+        // values in buckets up to b
+        for (size_t k = 1; k <= layout.one_pointers; ++k)
+            writer.write(high(k * quantum) + k * quantum, layout.pointer_width);
+        size_t count = 0;
+        for (size_t k = 1; k <= layout.zero_pointers; ++k) {
+            uint64_t bucket = k * quantum;
+            while (count < values.size() && high(count) <= bucket)
+                ++count;
+            writer.write(bucket + count, layout.pointer_width);
+        }
+
+        uint64_t low_mask = (uint64_t(1) << layout.low_bits) - 1;
+        for (auto value : values)
+            writer.write(uint64_t(value) & low_mask, layout.low_bits);
+
+        auto upper_start = writer.size();
+        writer.skip(layout.upper_bits);
+        for (size_t i = 0; i < values.size(); ++i)
+            writer.set(upper_start + high(i) + i);
+    }
+}
+
+// Read-only view of an Elias-Fano sequence
+class EliasFanoList {
+    private:
+        const uint64_t* words;
+        detail::EliasFanoLayout layout;
+        size_t quantum;
+        uint64_t pointers_start;
+        uint64_t lows_start;
+        uint64_t upper_start;
+
+    public:
+        class Iterator {
+            private:
+                const EliasFanoList* list;
+                size_t index;
+                uint64_t position;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = uint64_t;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const uint64_t*;
+                using reference = uint64_t;
+
+                Iterator() = default;
+                Iterator(const EliasFanoList* list, size_t index, uint64_t position):
+                    list(list), index(index), position(position) {}
+
+                inline auto operator*() const -> uint64_t {
+                    return this->list->value_at(this->index, this->position);
+                }
+
+                inline auto operator++() -> Iterator& {
+                    if (++this->index < this->list->size())
+                        this->position = this->list->next_one(this->position + 1);
+                    return *this;
+                }
+
+                inline auto operator++(int) -> Iterator {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                inline auto operator==(const Iterator& other) const -> bool {
+                    return this->index == other.index;
+                }
+        };
+
+        EliasFanoList(const uint64_t* words, uint64_t start, size_t size, uint64_t universe, size_t quantum):
+            words(words), layout(size, universe, quantum), quantum(quantum), pointers_start(start) {
+            this->lows_start = start + (this->layout.one_pointers + this->layout.zero_pointers) * this->layout.pointer_width;
+            this->upper_start = this->lows_start + size * this->layout.low_bits;
+        }
+
+        inline auto size() const -> size_t {
+            return this->layout.size;
+        }
+
+        inline auto end_position() const -> uint64_t {
+            return this->upper_start + this->layout.upper_bits;
+        }
+
+        inline auto operator[](size_t i) const -> uint64_t {
+            size_t k = i / this->quantum;
+            uint64_t position = k == 0 ? 0 : this->pointer(k - 1);
+            return this->value_at(i, this->select_one(position, i - k * this->quantum));
+        }
+
+        // Index of the first value that is at least x, or size() if there is none
+        inline auto lower_bound(uint64_t x) const -> size_t {
+            if (this->size() == 0 || x >= this->layout.universe)
+                return this->size();
+
+            uint64_t high = x >> this->layout.low_bits;
+            uint64_t position = 0;
+            if (high > 0) {
+                // The values in bucket high start after the zero closing bucket high - 1
+                uint64_t zero = high - 1;
+                size_t k = zero / this->quantum;
+                uint64_t from = k == 0 ? 0 : this->pointer(this->layout.one_pointers + k - 1);
+                position = this->select_zero(from, zero - k * this->quantum) + 1;
+            }
+
+            size_t index = position - high;
+            for (; index < this->size(); ++index) {
+                position = this->next_one(position);
+                if (this->value_at(index, position) >= x)
+                    break;
+                ++position;
+            }
+
+            return index;
+        }
+
+        inline auto begin() const -> Iterator {
+            return {this, 0, this->size() == 0 ? 0 : this->next_one(0)};
+        }
+
+        inline auto end() const -> Iterator {
+            return {this, this->size(), 0};
+        }
+
+    private:
+        inline auto pointer(size_t i) const -> uint64_t {
+            return detail::read_word_bits(this->words, this->pointers_start + i * this->layout.pointer_width,
+                                          this->layout.pointer_width);
+        }
+
+        inline auto value_at(size_t index, uint64_t position) const -> uint64_t {
+            uint64_t low = detail::read_word_bits(this->words, this->lows_start + index * this->layout.low_bits,
+                                                  this->layout.low_bits);
+            return ((position - index) << this->layout.low_bits) | low;
+        }
+
+        // Position of the first one in the upper bits at or after position
+        inline auto next_one(uint64_t position) const -> uint64_t {
+            return this->select_one(position, 0);
+        }
+
+        // Position of the rank-th one (or zero) in the upper bits at or after position
+        template <bool ONES = true>
+        inline auto select(uint64_t position, uint64_t rank) const -> uint64_t {
+            uint64_t absolute = this->upper_start + position;
+            size_t word_index = absolute / 64;
+            uint64_t word = (ONES ? this->words[word_index] : ~this->words[word_index]) & (~uint64_t(0) << (absolute % 64));
+            for (size_t count = std::popcount(word); count <= rank; count = std::popcount(word)) {
+                rank -= count;
+                ++word_index;
+                word = ONES ? this->words[word_index] : ~this->words[word_index];
+            }
+
+            for (; rank > 0; --rank)
+                word &= word - 1;
+            return word_index * 64 + std::countr_zero(word) - this->upper_start;
+        }
+
+        inline auto select_one(uint64_t position, uint64_t rank) const -> uint64_t {
+            return this->select<true>(position, rank);
+        }
+
+        inline auto select_zero(uint64_t position, uint64_t rank) const -> uint64_t {
+            return this->select<false>(position, rank);
+        }
+};
+
+template <std::unsigned_integral T>
+class EliasFanoGraph {
+    private:
+        std::vector<uint64_t> words;
+        size_t total_nodes;
+        size_t total_arcs;
+        size_t quantum;
+        // Bit offset and length of the successor lists, which follow the offsets of the lists relative to it
+        uint64_t lists_start;
+        uint64_t lists_bits;
+
+    public:
+        constexpr const static size_t default_quantum = 256;
+
+        EliasFanoGraph(const Graph<T>& graph, size_t quantum = default_quantum);
+        EliasFanoGraph(std::vector<uint64_t>&& words, size_t num_nodes, size_t num_arcs, size_t quantum, uint64_t list_bits);
+
+        auto successors(T node) const -> EliasFanoList;
+        auto outdegree(T node) const -> size_t;
+        // The i-th successor of node, of which there must be more than i
+        auto successor(T node, size_t i) const -> T;
+        auto has_arc(T from, T to) const -> bool;
+        // The smallest successor of node that is at least target
+        auto next_successor(T node, T target) const -> std::optional<T>;
+        auto to_graph() const -> Graph<T>;
+
+        // Call f(node, successors) concurrently for every node, balancing the threads by outdegree
+        // as in Graph::parallel_for_each
+        auto parallel_for_each(std::invocable<T, EliasFanoList> auto f, size_t threads = default_thread_count()) const -> void;
+        // Call f(state, node, successors) with the state of the calling thread, created by
+        // make_state(thread), and return the states of all threads
+        template <std::invocable<size_t> M, std::invocable<std::invoke_result_t<M, size_t>&, T, EliasFanoList> F>
+        auto parallel_for_each(M make_state, F f, size_t threads = default_thread_count()) const
+            -> std::vector<std::invoke_result_t<M, size_t>>;
+
+        // The same as successors, so that algorithms can take either this or a Graph
+        inline auto neighbours(T node) const -> EliasFanoList {
+            return this->successors(node);
+        }
+
+        inline auto num_nodes() const -> size_t {
+            return this->total_nodes;
+        }
+
+        inline auto num_arcs() const -> size_t {
+            return this->total_arcs;
+        }
+
+        inline auto skip_quantum() const -> size_t {
+            return this->quantum;
+        }
+
+        inline auto list_bits() const -> uint64_t {
+            return this->lists_bits;
+        }
+
+        inline auto data() const -> std::span<const uint64_t> {
+            return std::span(this->words).first(this->words.size() - 1);
+        }
+
+    private:
+        auto offsets() const -> EliasFanoList;
+};
+
+template <std::unsigned_integral T>
+EliasFanoGraph<T>::EliasFanoGraph(const Graph<T>& graph, size_t quantum):
+    total_nodes(graph.num_nodes()), total_arcs(0), quantum(std::max<size_t>(quantum, 1)) {
+    auto lists = detail::WordBitWriter();
+    auto list_offsets = std::vector<uint64_t>();
+    list_offsets.reserve(this->total_nodes + 1);
+    for (size_t node = 0; node < this->total_nodes; ++node) {
+        auto neighbours = graph.neighbours(node);
+        list_offsets.push_back(lists.size());
+        lists.write_gamma(neighbours.size());
+        detail::write_elias_fano(lists, neighbours, this->total_nodes, this->quantum);
+        this->total_arcs += neighbours.size();
+    }
+    list_offsets.push_back(lists.size());
+    this->lists_bits = lists.size();
+
+    auto writer = detail::WordBitWriter();
+    detail::write_elias_fano(writer, std::span<const uint64_t>(list_offsets), list_offsets.back() + 1, this->quantum);
+    writer.align();
+    this->lists_start = writer.size();
+
+    this->words = writer.release();
+    this->words.pop_back();
+    auto list_words = lists.release();
+    this->words.insert(this->words.end(), list_words.begin(), list_words.end());
+}
+
+template <std::unsigned_integral T>
+EliasFanoGraph<T>::EliasFanoGraph(std::vector<uint64_t>&& words, size_t num_nodes, size_t num_arcs,
+                                  size_t quantum, uint64_t list_bits):
+    words(std::move(words)), total_nodes(num_nodes), total_arcs(num_arcs), quantum(std::max<size_t>(quantum, 1)),
+    lists_bits(list_bits) {
+    auto layout = detail::EliasFanoLayout(num_nodes + 1, list_bits + 1, this->quantum);
+    this->lists_start = (layout.total_bits() + 63) / 64 * 64;
+    if ((this->lists_start + list_bits + 63) / 64 > this->words.size())
+        throw EncodingException("Elias-Fano graph is truncated");
+    this->words.push_back(0);
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::offsets() const -> EliasFanoList {
+    return EliasFanoList(this->words.data(), 0, this->total_nodes + 1, this->lists_bits + 1, this->quantum);
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::successors(T node) const -> EliasFanoList {
+    uint64_t position = this->lists_start + this->offsets()[node];
+    size_t degree = detail::read_word_gamma(this->words.data(), position);
+    return EliasFanoList(this->words.data(), position, degree, this->total_nodes, this->quantum);
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::outdegree(T node) const -> size_t {
+    uint64_t position = this->lists_start + this->offsets()[node];
+    return detail::read_word_gamma(this->words.data(), position);
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::parallel_for_each(std::invocable<T, EliasFanoList> auto f, size_t threads) const -> void {
+    auto weight = [&](size_t node) {
+        return this->outdegree(node) + 1;
+    };
+    parallel_for_weighted(0, this->total_nodes, threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            f(T(i), this->successors(i));
+    });
+}
+
+template <std::unsigned_integral T>
+template <std::invocable<size_t> M, std::invocable<std::invoke_result_t<M, size_t>&, T, EliasFanoList> F>
+auto EliasFanoGraph<T>::parallel_for_each(M make_state, F f, size_t threads) const
+    -> std::vector<std::invoke_result_t<M, size_t>> {
+    auto weight = [&](size_t node) {
+        return this->outdegree(node) + 1;
+    };
+    return parallel_for_each_weighted(0, this->total_nodes, threads, weight, make_state, [&](auto& state, size_t i) {
+        f(state, T(i), this->successors(i));
+    });
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::successor(T node, size_t i) const -> T {
+    return this->successors(node)[i];
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::has_arc(T from, T to) const -> bool {
+    auto list = this->successors(from);
+    auto i = list.lower_bound(to);
+    return i < list.size() && list[i] == to;
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::next_successor(T node, T target) const -> std::optional<T> {
+    auto list = this->successors(node);
+    auto i = list.lower_bound(target);
+    if (i == list.size())
+        return std::nullopt;
+    return list[i];
+}
+
+template <std::unsigned_integral T>
+auto EliasFanoGraph<T>::to_graph() const -> Graph<T> {
+    auto nodes = std::vector<typename Graph<T>::Node>(this->total_nodes, {0, 0});
+    auto edges = std::vector<T>();
+    edges.reserve(this->total_arcs);
+
+    for (size_t node = 0; node < this->total_nodes; ++node) {
+        auto list = this->successors(node);
+        nodes[node] = {edges.size(), list.size()};
+        for (auto successor : list)
+            edges.push_back(successor);
+    }
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+#endif
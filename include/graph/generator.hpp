@@ -0,0 +1,365 @@
+#ifndef _JORMUNGANDR_GRAPH_GENERATOR_HPP
+#define _JORMUNGANDR_GRAPH_GENERATOR_HPP
+
+#include "graph/graph.hpp"
+#include "exceptions.hpp"
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+
+enum class GeneratorModel {
+    // Recursive matrix, the Kronecker graph of a 2x2 matrix of quadrant probabilities
+    RMAT,
+    // Web-like: nodes copy successors of a recent node of the same host, other successors are
+    // mostly on the same host
+    COPYING,
+    // Every arc exists with the same probability
+    ERDOS_RENYI,
+    // Power law outdegrees, with targets drawn in proportion to power law indegree weights
+    CONFIGURATION
+};
+
+auto generator_model_from_string(std::string_view name) -> GeneratorModel;
+auto generator_model_to_string(GeneratorModel model) -> std::string;
+
+struct GeneratorConfig {
+    GeneratorModel model = GeneratorModel::COPYING;
+    uint64_t num_nodes = 1 << 20;
+    // Expected number of arcs, before duplicate arcs are removed
+    uint64_t num_arcs = 1 << 24;
+    uint64_t seed = 0;
+
+    // Probability of the quadrants of R-MAT, in order top left, top right and bottom left, of
+    // which the bottom right gets the remainder
+    double rmat_a = 0.57;
+    double rmat_b = 0.19;
+    double rmat_c = 0.19;
+
+    // Probability of the copying model to copy each successor of the prototype, and of the other
+    // successors to be on the same host
+    double copy_probability = 0.7;
+    double host_locality = 0.8;
+    uint64_t mean_host_size = 64;
+    // Number of preceding nodes the copying model picks prototypes from
+    uint64_t copy_window = 32;
+
+    // Exponent of the outdegrees of the copying and configuration models, and of the indegrees of
+    // the configuration model
+    double exponent = 2.5;
+};
+
+// Generates a random graph as a node stream, which can be pushed to an encoder without keeping
+// the graph in memory, or collected with decode(). The same config and seed always produce the
+// same graph, with any standard library, as every sample is derived from the raw output of
+// mt19937_64 rather than from the standard distributions. Successor lists are sorted and without
+// duplicates. R-MAT graphs have the next power of two of nodes, as every level of the recursion
+// halves the nodes.
+template <std::unsigned_integral T>
+class GraphGenerator {
+    public:
+        struct Node {
+            T index;
+            std::span<const T> neighbours;
+        };
+
+    private:
+        // Rows of the R-MAT matrix yet to be split, with the number of arcs in them
+        struct RmatRange {
+            uint64_t first;
+            uint32_t level;
+            uint64_t arcs;
+        };
+
+        GeneratorConfig config;
+        uint64_t total_nodes;
+        uint64_t next_node_index;
+        std::mt19937_64 rng;
+        std::vector<T> current;
+
+        uint32_t scale;
+        std::vector<RmatRange> rmat_ranges;
+
+        uint64_t host_first;
+        uint64_t host_last;
+        // The lists of the last copy_window nodes, by node modulo copy_window
+        std::vector<std::vector<T>> recent;
+
+        // Odd multiplier of the permutation scattering nodes of the configuration model
+        uint64_t scatter_multiplier;
+
+    public:
+        GraphGenerator(const GeneratorConfig& config);
+
+        auto next_node() -> std::optional<Node>;
+        auto decode() -> Graph<T>;
+
+        inline auto num_nodes() const -> uint64_t {
+            return this->total_nodes;
+        }
+
+    private:
+        auto uniform(uint64_t first, uint64_t last) -> uint64_t;
+        // A double in [0, 1)
+        auto unit() -> double;
+        auto chance(double p) -> bool;
+        // The number of failures before the first success
+        auto geometric(double p) -> uint64_t;
+        auto binomial(uint64_t n, double p) -> uint64_t;
+        // An outdegree from a power law with the configured exponent and the mean outdegree
+        auto power_law_degree() -> uint64_t;
+
+        auto generate_rmat(uint64_t node) -> void;
+        auto generate_copying(uint64_t node) -> void;
+        auto generate_erdos_renyi(uint64_t node) -> void;
+        auto generate_configuration() -> void;
+        auto scatter(uint64_t rank) const -> uint64_t;
+};
+
+template <std::unsigned_integral T>
+GraphGenerator<T>::GraphGenerator(const GeneratorConfig& config):
+    config(config), total_nodes(config.num_nodes), next_node_index(0), rng(config.seed),
+    scale(0), host_first(0), host_last(0), scatter_multiplier(1) {
+    if (this->total_nodes == 0)
+        throw PropertyException("Generated graphs need at least one node");
+    if (this->config.exponent <= 2 && (this->config.model == GeneratorModel::COPYING ||
+                                       this->config.model == GeneratorModel::CONFIGURATION))
+        throw PropertyException("Power law exponent ", this->config.exponent, " has no finite mean, it must exceed 2");
+
+    if (this->config.model == GeneratorModel::RMAT) {
+        double d = 1 - this->config.rmat_a - this->config.rmat_b - this->config.rmat_c;
+        if (this->config.rmat_a <= 0 || this->config.rmat_b <= 0 || this->config.rmat_c <= 0 || d <= 0)
+            throw PropertyException("R-MAT probabilities must be positive and add up to less than 1");
+        this->scale = std::bit_width(this->total_nodes - 1);
+        this->total_nodes = uint64_t(1) << this->scale;
+        this->rmat_ranges.push_back({0, this->scale, this->config.num_arcs});
+    } else if (this->config.model == GeneratorModel::COPYING) {
+        this->recent.resize(std::max<uint64_t>(this->config.copy_window, 1));
+    } else if (this->config.model == GeneratorModel::CONFIGURATION) {
+        this->scatter_multiplier = this->rng() | 1;
+    }
+
+    if (this->total_nodes - 1 > std::numeric_limits<T>::max())
+        throw TypeCastException("Generated graph with ", this->total_nodes, " nodes does not fit the node type");
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::next_node() -> std::optional<Node> {
+    if (this->next_node_index >= this->total_nodes)
+        return std::nullopt;
+
+    uint64_t node = this->next_node_index++;
+    this->current.clear();
+    switch (this->config.model) {
+        case GeneratorModel::RMAT:
+            this->generate_rmat(node);
+            break;
+        case GeneratorModel::COPYING:
+            this->generate_copying(node);
+            break;
+        case GeneratorModel::ERDOS_RENYI:
+            this->generate_erdos_renyi(node);
+            break;
+        case GeneratorModel::CONFIGURATION:
+            this->generate_configuration();
+            break;
+    }
+
+    std::sort(this->current.begin(), this->current.end());
+    this->current.erase(std::unique(this->current.begin(), this->current.end()), this->current.end());
+    if (this->config.model == GeneratorModel::COPYING)
+        this->recent[node % this->recent.size()] = this->current;
+
+    return {{T(node), this->current}};
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::decode() -> Graph<T> {
+    auto nodes = std::vector<typename Graph<T>::Node>(this->total_nodes, {0, 0});
+    auto edges = std::vector<T>();
+
+    while (auto node = this->next_node()) {
+        nodes[node->index].first_edge = edges.size();
+        nodes[node->index].num_edges = node->neighbours.size();
+        std::copy(node->neighbours.begin(), node->neighbours.end(), std::back_inserter(edges));
+    }
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::uniform(uint64_t first, uint64_t last) -> uint64_t {
+    // Draws as many bits as the range needs, until they fall within it, which takes at most two
+    // draws on average
+    uint64_t range = last - first;
+    uint64_t mask = range > 1 ? ~uint64_t(0) >> std::countl_zero(range - 1) : 0;
+    uint64_t value;
+    do {
+        value = this->rng() & mask;
+    } while (value >= range);
+    return first + value;
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::unit() -> double {
+    // The top 53 bits, which is as many as a double holds
+    return double(this->rng() >> 11) * 0x1p-53;
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::chance(double p) -> bool {
+    return this->unit() < p;
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::geometric(double p) -> uint64_t {
+    if (p >= 1)
+        return 0;
+    // Inverse of the distribution function, capped so that adding to the result cannot overflow
+    double failures = std::floor(std::log1p(-this->unit()) / std::log1p(-p));
+    return std::min(failures, 0x1p62);
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::binomial(uint64_t n, double p) -> uint64_t {
+    // Every trial compares 16 random bits with p, like the columns of R-MAT, so that a random word
+    // is enough for four trials
+    uint64_t threshold = std::clamp(p, 0.0, 1.0) * 0x10000;
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n; i += 4) {
+        uint64_t random = this->rng();
+        for (uint64_t j = i; j < std::min(n, i + 4); ++j) {
+            count += (random & 0xffff) < threshold;
+            random >>= 16;
+        }
+    }
+    return count;
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::power_law_degree() -> uint64_t {
+    // A Pareto distribution with minimum xmin has mean xmin * (exponent - 1) / (exponent - 2)
+    double exponent = this->config.exponent;
+    double mean = double(this->config.num_arcs) / this->total_nodes;
+    double xmin = mean * (exponent - 2) / (exponent - 1);
+    double u = this->unit();
+    double degree = xmin * std::pow(1 - u, -1 / (exponent - 1));
+    return std::min<double>(std::round(degree), this->total_nodes);
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::generate_rmat(uint64_t node) -> void {
+    // The arcs of a range of rows are split between its halves binomially, depth first, until the
+    // range is the row of the node. The halves with no arcs are dropped, so the top of the stack
+    // is the first range with arcs not before node.
+    uint64_t arcs = 0;
+    double top = this->config.rmat_a + this->config.rmat_b;
+    while (!this->rmat_ranges.empty() && this->rmat_ranges.back().first <= node) {
+        auto range = this->rmat_ranges.back();
+        this->rmat_ranges.pop_back();
+        if (range.level == 0) {
+            arcs = range.arcs;
+            break;
+        }
+
+        uint64_t upper = this->binomial(range.arcs, top);
+        uint64_t half = uint64_t(1) << (range.level - 1);
+        if (range.arcs > upper)
+            this->rmat_ranges.push_back({range.first + half, range.level - 1, range.arcs - upper});
+        if (upper > 0)
+            this->rmat_ranges.push_back({range.first, range.level - 1, upper});
+    }
+
+    // Given the row, every bit of the column only depends on the bit of the row at the same level.
+    // Each bit is drawn from 16 random bits, so that a random word is enough for four levels.
+    uint64_t right_of_top = this->config.rmat_b / top * 0x10000;
+    uint64_t right_of_bottom = (1 - top - this->config.rmat_c) / (1 - top) * 0x10000;
+    for (uint64_t arc = 0; arc < arcs; ++arc) {
+        uint64_t target = 0;
+        uint64_t random = 0;
+        for (uint32_t level = this->scale; level > 0; --level) {
+            if ((this->scale - level) % 4 == 0)
+                random = this->rng();
+            bool bottom = (node >> (level - 1)) & 1;
+            target = target << 1 | ((random & 0xffff) < (bottom ? right_of_bottom : right_of_top));
+            random >>= 16;
+        }
+        this->current.push_back(target);
+    }
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::generate_copying(uint64_t node) -> void {
+    if (node >= this->host_last) {
+        this->host_first = node;
+        uint64_t size = this->geometric(1.0 / std::max<uint64_t>(this->config.mean_host_size, 1)) + 1;
+        this->host_last = std::min(node + size, this->total_nodes);
+    }
+
+    // The prototype is one of the recent nodes of the same host, if there are any
+    uint64_t window_first = std::max(this->host_first, node - std::min<uint64_t>(node, this->recent.size()));
+    const std::vector<T>* prototype = nullptr;
+    if (window_first < node)
+        prototype = &this->recent[this->uniform(window_first, node) % this->recent.size()];
+
+    uint64_t degree = this->power_law_degree();
+    for (uint64_t i = 0; i < degree; ++i) {
+        if (prototype && i < prototype->size() && this->chance(this->config.copy_probability))
+            this->current.push_back((*prototype)[i]);
+        else if (this->chance(this->config.host_locality))
+            this->current.push_back(this->uniform(this->host_first, this->host_last));
+        else
+            this->current.push_back(this->uniform(0, this->total_nodes));
+    }
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::generate_erdos_renyi(uint64_t node) -> void {
+    if (this->total_nodes < 2)
+        return;
+
+    // Skip over the absent arcs with geometric gaps, among the n - 1 targets other than node
+    double p = std::min(double(this->config.num_arcs) / this->total_nodes / (this->total_nodes - 1), 1.0);
+    if (p <= 0)
+        return;
+
+    for (uint64_t target = this->geometric(p); target < this->total_nodes - 1; target += this->geometric(p) + 1)
+        this->current.push_back(target < node ? target : target + 1);
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::generate_configuration() -> void {
+    // Chung-Lu: the target of rank r has weight (r + 1)^-beta, which gives power law indegrees
+    // with the configured exponent. Ranks are drawn by inverting the continuous distribution.
+    double beta = 1 / (this->config.exponent - 1);
+    double n = double(this->total_nodes);
+    uint64_t degree = this->power_law_degree();
+    for (uint64_t i = 0; i < degree; ++i) {
+        double u = this->unit();
+        double rank = std::pow(1 + u * (std::pow(n + 1, 1 - beta) - 1), 1 / (1 - beta)) - 1;
+        this->current.push_back(this->scatter(std::min<uint64_t>(rank, this->total_nodes - 1)));
+    }
+}
+
+template <std::unsigned_integral T>
+auto GraphGenerator<T>::scatter(uint64_t rank) const -> uint64_t {
+    // Multiplying by an odd number permutes the integers modulo a power of two, which is restricted
+    // to the nodes by applying it again until the result is a node
+    uint64_t mask = std::bit_ceil(this->total_nodes) - 1;
+    uint64_t node = rank;
+    do {
+        node = (node * this->scatter_multiplier + 1) & mask;
+    } while (node >= this->total_nodes);
+    return node;
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _JORMUNGANDR_GRAPH_GRAPH_HPP
 #define _JORMUNGANDR_GRAPH_GRAPH_HPP
 
+#include "parallel.hpp"
+
 #include <vector>
 #include <concepts>
 #include <span>
@@ -13,6 +15,9 @@ concept ForEachNeighbourCallback = std::invocable<F, T>;
 template <typename F, typename T>
 concept ForEachNodeCallback = std::invocable<F, T, std::span<const T>>;
 
+template <typename F, typename S, typename T>
+concept ForEachNodeStateCallback = std::invocable<F, S&, T, std::span<const T>>;
+
 template <std::unsigned_integral T>
 class Graph {
     public:
@@ -32,6 +37,14 @@ class Graph {
 
         auto for_each_neighbour(T node, ForEachNeighbourCallback<T> auto f) const -> void;
         auto for_each(ForEachNodeCallback<T> auto f) const -> void;
+        // Like for_each, but f is called concurrently. The nodes are split into ranges of about
+        // the same number of arcs, which idle threads steal from each other.
+        auto parallel_for_each(ForEachNodeCallback<T> auto f, size_t threads = default_thread_count()) const -> void;
+        // Call f(state, node, neighbours) with the state of the calling thread, created by
+        // make_state(thread), and return the states of all threads
+        template <std::invocable<size_t> M, ForEachNodeStateCallback<std::invoke_result_t<M, size_t>, T> F>
+        auto parallel_for_each(M make_state, F f, size_t threads = default_thread_count()) const
+            -> std::vector<std::invoke_result_t<M, size_t>>;
         auto neighbours(T node) const -> std::span<const T>;
         auto num_nodes() const -> size_t;
 };
@@ -98,6 +111,29 @@ auto Graph<T>::for_each(ForEachNodeCallback<T> auto f) const -> void {
     }
 }
 
+template <std::unsigned_integral T>
+auto Graph<T>::parallel_for_each(ForEachNodeCallback<T> auto f, size_t threads) const -> void {
+    auto weight = [&](size_t node) {
+        return this->nodes[node].num_edges + 1;
+    };
+    parallel_for_weighted(0, this->nodes.size(), threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            f(T(i), this->neighbours(i));
+    });
+}
+
+template <std::unsigned_integral T>
+template <std::invocable<size_t> M, ForEachNodeStateCallback<std::invoke_result_t<M, size_t>, T> F>
+auto Graph<T>::parallel_for_each(M make_state, F f, size_t threads) const
+    -> std::vector<std::invoke_result_t<M, size_t>> {
+    auto weight = [&](size_t node) {
+        return this->nodes[node].num_edges + 1;
+    };
+    return parallel_for_each_weighted(0, this->nodes.size(), threads, weight, make_state, [&](auto& state, size_t i) {
+        f(state, T(i), this->neighbours(i));
+    });
+}
+
 template <std::unsigned_integral T>
 auto Graph<T>::neighbours(T node) const -> std::span<const T> {
     auto [start, len] = this->nodes[node];
@@ -0,0 +1,86 @@
+#ifndef _JORMUNGANDR_GRAPH_INTERSECT_HPP
+#define _JORMUNGANDR_GRAPH_INTERSECT_HPP
+
+#include <span>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+// Intersections of sorted lists without duplicates, such as the successor lists of a Graph.
+
+// When one list is this many times longer than the other, the shorter list is looked up in the
+// longer one by galloping instead of merging both
+constexpr const size_t gallop_ratio = 32;
+
+// Count the common values of two sorted lists of 32-bit values, using SIMD instructions if available
+auto intersection_size_u32(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size) -> size_t;
+
+// The index of the first value in list that is at least x, searching exponentially from start
+template <std::unsigned_integral T>
+inline auto gallop(std::span<const T> list, size_t start, T x) -> size_t {
+    size_t step = 1;
+    size_t end = start;
+    while (end < list.size() && list[end] < x) {
+        start = end + 1;
+        end += step;
+        step *= 2;
+    }
+
+    end = std::min(end, list.size());
+    return std::lower_bound(list.begin() + start, list.begin() + end, x) - list.begin();
+}
+
+// Call f for every value in both a and b, in increasing order
+template <std::unsigned_integral T, typename F>
+auto for_each_common(std::span<const T> a, std::span<const T> b, F f) -> void {
+    if (a.size() > b.size())
+        std::swap(a, b);
+
+    if (a.size() * gallop_ratio < b.size()) {
+        size_t j = 0;
+        for (auto x : a) {
+            j = gallop(b, j, x);
+            if (j == b.size())
+                return;
+            if (b[j] == x)
+                f(x);
+        }
+        return;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            f(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+// The number of values in both a and b
+template <std::unsigned_integral T>
+auto intersection_size(std::span<const T> a, std::span<const T> b) -> size_t {
+    if (a.size() > b.size())
+        std::swap(a, b);
+
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        if (a.size() * gallop_ratio >= b.size())
+            return intersection_size_u32(a.data(), a.size(), b.data(), b.size());
+    }
+
+    size_t count = 0;
+    for_each_common(a, b, [&](T) {
+        ++count;
+    });
+    return count;
+}
+
+#endif
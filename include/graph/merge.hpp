@@ -0,0 +1,76 @@
+#ifndef _JORMUNGANDR_GRAPH_MERGE_HPP
+#define _JORMUNGANDR_GRAPH_MERGE_HPP
+
+#include "decode/decoder.hpp"
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <concepts>
+
+// Produces the union of two node streams, that is, for every node the sorted union of its successor
+// lists in either stream. Only the current list of each is kept in memory. Nodes missing from a
+// stream, for example because it has fewer nodes, are treated as having no successors.
+template <std::unsigned_integral T, NodeStream<T> A, NodeStream<T> B>
+class MergeStream {
+    public:
+        struct Node {
+            T index;
+            std::span<const T> neighbours;
+        };
+
+    private:
+        A& a;
+        B& b;
+        T total_nodes;
+        T next_node_index;
+        decltype(a.next_node()) pending_a;
+        decltype(b.next_node()) pending_b;
+        std::vector<T> current;
+
+    public:
+        MergeStream(A& a, B& b, T num_nodes);
+
+        auto next_node() -> std::optional<Node>;
+
+        inline auto num_nodes() const -> T {
+            return this->total_nodes;
+        }
+};
+
+template <std::unsigned_integral T, NodeStream<T> A, NodeStream<T> B>
+MergeStream<T, A, B>::MergeStream(A& a, B& b, T num_nodes):
+    a(a), b(b), total_nodes(num_nodes), next_node_index(0),
+    pending_a(a.next_node()), pending_b(b.next_node()) {}
+
+template <std::unsigned_integral T, NodeStream<T> A, NodeStream<T> B>
+auto MergeStream<T, A, B>::next_node() -> std::optional<Node> {
+    if (this->next_node_index >= this->total_nodes)
+        return std::nullopt;
+
+    T index = this->next_node_index++;
+    auto from_a = std::span<const T>();
+    auto from_b = std::span<const T>();
+
+    // The lists are views into the streams, so they may only be advanced after merging
+    bool advance_a = this->pending_a && this->pending_a->index == index;
+    bool advance_b = this->pending_b && this->pending_b->index == index;
+    if (advance_a)
+        from_a = this->pending_a->neighbours;
+    if (advance_b)
+        from_b = this->pending_b->neighbours;
+
+    this->current.clear();
+    std::set_union(from_a.begin(), from_a.end(), from_b.begin(), from_b.end(), std::back_inserter(this->current));
+
+    if (advance_a)
+        this->pending_a = this->a.next_node();
+    if (advance_b)
+        this->pending_b = this->b.next_node();
+
+    return {{index, this->current}};
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef _JORMUNGANDR_GRAPH_PAGERANK_HPP
+#define _JORMUNGANDR_GRAPH_PAGERANK_HPP
+
+#include "decode/streaming.hpp"
+
+#include <vector>
+#include <span>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+struct PageRankOptions {
+    double damping = 0.85;
+    size_t max_iterations = 100;
+    // Stop once the L1 norm of the change in ranks drops below this
+    double tolerance = 1e-9;
+};
+
+struct PageRankResult {
+    std::vector<double> ranks;
+    size_t iterations;
+    double error;
+};
+
+// PageRank with uniform teleportation, of which the rank of dangling nodes is redistributed
+// uniformly as well. Every iteration is a single pass over the graph that pushes the rank of each
+// node to its successors, so only the current and next ranks are kept in memory.
+template <std::unsigned_integral T>
+auto pagerank(StreamingGraph<T>& graph, const PageRankOptions& options = {}) -> PageRankResult {
+    size_t n = graph.num_nodes();
+    auto result = PageRankResult{std::vector<double>(n, n > 0 ? 1.0 / n : 0), 0, 0};
+    if (n == 0)
+        return result;
+
+    auto& ranks = result.ranks;
+    auto next = std::vector<double>(n);
+    bool concurrent = graph.num_threads() > 1;
+    while (result.iterations < options.max_iterations) {
+        std::fill(next.begin(), next.end(), 0);
+        graph.for_each([&](T node, std::span<const T> successors) {
+            if (successors.empty())
+                return;
+
+            double share = ranks[node] / successors.size();
+            if (concurrent) {
+                for (auto successor : successors)
+                    std::atomic_ref(next[successor]).fetch_add(share, std::memory_order_relaxed);
+            } else {
+                for (auto successor : successors)
+                    next[successor] += share;
+            }
+        });
+
+        // Whatever was not pushed to a successor belonged to a dangling node
+        double total = 0;
+        double pushed = 0;
+        for (size_t node = 0; node < n; ++node) {
+            total += ranks[node];
+            pushed += next[node];
+        }
+
+        double base = (1 - options.damping) / n + options.damping * std::max(total - pushed, 0.0) / n;
+        result.error = 0;
+        for (size_t node = 0; node < n; ++node) {
+            double rank = base + options.damping * next[node];
+            result.error += std::abs(rank - ranks[node]);
+            ranks[node] = rank;
+        }
+
+        ++result.iterations;
+        if (result.error < options.tolerance)
+            break;
+    }
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef _JORMUNGANDR_GRAPH_REORDER_HPP
+#define _JORMUNGANDR_GRAPH_REORDER_HPP
+
+#include "graph/graph.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <span>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+
+// Permutations map every node to its new index, that is, node u becomes permutation[u].
+
+enum class ReorderStrategy {
+    BFS,
+    LEXICOGRAPHIC,
+    GRAY,
+    LLP
+};
+
+struct LlpOptions {
+    // Resolutions to cluster at, the labels of later gammas take precedence in the final order.
+    std::vector<double> gammas = {
+        1.0, 1.0 / 2, 1.0 / 4, 1.0 / 8, 1.0 / 16, 1.0 / 32, 1.0 / 64,
+        1.0 / 128, 1.0 / 256, 1.0 / 512, 1.0 / 1024, 0.0
+    };
+    size_t max_iterations = 20;
+    // Stop iterating once fewer than this fraction of the nodes changed label
+    double min_change_ratio = 0.001;
+    uint64_t seed = 0;
+};
+
+namespace detail {
+    template <std::unsigned_integral T>
+    auto order_to_permutation(const std::vector<T>& order) -> std::vector<T> {
+        auto permutation = std::vector<T>(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            permutation[order[i]] = i;
+        return permutation;
+    }
+
+    template <std::unsigned_integral T>
+    auto gray_less(std::span<const T> a, std::span<const T> b) -> bool {
+        // Compare the lists as bit vectors with the lowest node as most significant bit
+        size_t i = 0;
+        while (i < a.size() && i < b.size() && a[i] == b[i])
+            ++i;
+
+        if (i == a.size() && i == b.size())
+            return false;
+
+        // Whether a has a one where the bit vectors first differ, there are i ones before it in both
+        bool a_has = i < a.size() && (i >= b.size() || a[i] < b[i]);
+        return a_has == (i % 2 == 1);
+    }
+
+    template <std::unsigned_integral T>
+    auto label_propagation(const Graph<T>& symmetric, double gamma, const LlpOptions& options,
+                           std::mt19937_64& rng) -> std::vector<T> {
+        size_t n = symmetric.num_nodes();
+        auto labels = std::vector<T>(n);
+        std::iota(labels.begin(), labels.end(), 0);
+        auto volumes = std::vector<uint64_t>(n, 1);
+
+        auto counts = std::vector<uint64_t>(n, 0);
+        auto touched = std::vector<T>();
+        auto order = std::vector<T>(n);
+        std::iota(order.begin(), order.end(), 0);
+
+        for (size_t iteration = 0; iteration < options.max_iterations; ++iteration) {
+            std::shuffle(order.begin(), order.end(), rng);
+            size_t changes = 0;
+
+            for (auto u : order) {
+                auto neighbours = symmetric.neighbours(u);
+                if (neighbours.empty())
+                    continue;
+
+                touched.clear();
+                for (auto v : neighbours) {
+                    if (counts[labels[v]]++ == 0)
+                        touched.push_back(labels[v]);
+                }
+
+                // Maximize k_l - gamma * (v_l - k_l), not counting u itself in the volume of its own label
+                T current = labels[u];
+                --volumes[current];
+                T best = current;
+                double best_value = counts[current] - gamma * (double(volumes[current]) - counts[current]);
+                for (auto label : touched) {
+                    double value = counts[label] - gamma * (double(volumes[label]) - counts[label]);
+                    if (value > best_value || (value == best_value && label < best && best != current)) {
+                        best_value = value;
+                        best = label;
+                    }
+                    counts[label] = 0;
+                }
+
+                ++volumes[best];
+                if (best != current) {
+                    labels[u] = best;
+                    ++changes;
+                }
+            }
+
+            if (changes <= options.min_change_ratio * n)
+                break;
+        }
+
+        return labels;
+    }
+}
+
+template <std::unsigned_integral T>
+auto bfs_order(const Graph<T>& graph) -> std::vector<T> {
+    size_t n = graph.num_nodes();
+    auto visited = std::vector<bool>(n, false);
+    auto order = std::vector<T>();
+    order.reserve(n);
+
+    for (size_t root = 0; root < n; ++root) {
+        if (visited[root])
+            continue;
+
+        visited[root] = true;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            graph.for_each_neighbour(order[head++], [&](T v) {
+                if (!visited[v]) {
+                    visited[v] = true;
+                    order.push_back(v);
+                }
+            });
+        }
+    }
+
+    return detail::order_to_permutation(order);
+}
+
+template <std::unsigned_integral T>
+auto lexicographic_order(const Graph<T>& graph) -> std::vector<T> {
+    auto order = std::vector<T>(graph.num_nodes());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](T a, T b) {
+        auto na = graph.neighbours(a);
+        auto nb = graph.neighbours(b);
+        return std::lexicographical_compare(na.begin(), na.end(), nb.begin(), nb.end());
+    });
+
+    return detail::order_to_permutation(order);
+}
+
+template <std::unsigned_integral T>
+auto gray_order(const Graph<T>& graph) -> std::vector<T> {
+    auto order = std::vector<T>(graph.num_nodes());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](T a, T b) {
+        return detail::gray_less(graph.neighbours(a), graph.neighbours(b));
+    });
+
+    return detail::order_to_permutation(order);
+}
+
+// Layered Label Propagation: cluster the symmetrized graph at every gamma, and order the nodes
+// such that nodes with the same label are consecutive.
+template <std::unsigned_integral T>
+auto llp_order(const Graph<T>& graph, const LlpOptions& options = {}) -> std::vector<T> {
+    size_t n = graph.num_nodes();
+    auto srcs = std::vector<T>();
+    auto dsts = std::vector<T>();
+    graph.for_each([&](T u, std::span<const T> neighbours) {
+        for (auto v : neighbours) {
+            if (u == v)
+                continue;
+            srcs.push_back(u);
+            dsts.push_back(v);
+            srcs.push_back(v);
+            dsts.push_back(u);
+        }
+    });
+    auto symmetric = Graph<T>(std::move(srcs), std::move(dsts));
+
+    auto rng = std::mt19937_64(options.seed);
+    auto order = std::vector<T>(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto first_position = std::vector<size_t>(n);
+
+    for (auto gamma : options.gammas) {
+        auto labels = detail::label_propagation(symmetric, gamma, options, rng);
+
+        // Nodes in symmetric beyond the last node with arcs keep their own label
+        if (labels.size() < n) {
+            size_t old_size = labels.size();
+            labels.resize(n);
+            std::iota(labels.begin() + old_size, labels.end(), old_size);
+        }
+
+        // Group nodes by label, ordering the groups by where their first node currently is
+        std::fill(first_position.begin(), first_position.end(), n);
+        for (size_t i = 0; i < n; ++i)
+            first_position[labels[order[i]]] = std::min(first_position[labels[order[i]]], i);
+        std::stable_sort(order.begin(), order.end(), [&](T a, T b) {
+            return first_position[labels[a]] < first_position[labels[b]];
+        });
+    }
+
+    return detail::order_to_permutation(order);
+}
+
+template <std::unsigned_integral T>
+auto compute_order(const Graph<T>& graph, ReorderStrategy strategy) -> std::vector<T> {
+    switch (strategy) {
+        case ReorderStrategy::BFS:
+            return bfs_order(graph);
+        case ReorderStrategy::LEXICOGRAPHIC:
+            return lexicographic_order(graph);
+        case ReorderStrategy::GRAY:
+            return gray_order(graph);
+        case ReorderStrategy::LLP:
+            return llp_order(graph);
+    }
+
+    return {};
+}
+
+template <std::unsigned_integral T>
+auto permute(const Graph<T>& graph, const std::vector<T>& permutation, size_t threads) -> Graph<T> {
+    size_t n = graph.num_nodes();
+    auto nodes = std::vector<typename Graph<T>::Node>(n, {0, 0});
+
+    parallel_for_range(0, n, threads, [&](size_t first, size_t last) {
+        for (size_t u = first; u < last; ++u)
+            nodes[permutation[u]].num_edges = graph.neighbours(u).size();
+    });
+
+    size_t offset = 0;
+    for (auto& node : nodes) {
+        node.first_edge = offset;
+        offset += node.num_edges;
+    }
+
+    auto edges = std::vector<T>(offset);
+    parallel_for_range(0, n, threads, [&](size_t first, size_t last) {
+        for (size_t u = first; u < last; ++u) {
+            auto [start, len] = nodes[permutation[u]];
+            auto neighbours = graph.neighbours(u);
+            for (size_t i = 0; i < len; ++i)
+                edges[start + i] = permutation[neighbours[i]];
+            std::sort(edges.begin() + start, edges.begin() + start + len);
+        }
+    });
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _JORMUNGANDR_GRAPH_SUBGRAPH_HPP
+#define _JORMUNGANDR_GRAPH_SUBGRAPH_HPP
+
+#include "decode/decoder.hpp"
+#include "graph/bitmap.hpp"
+#include "exceptions.hpp"
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <concepts>
+
+// Mark the nodes below num_nodes for which keep(node) holds
+template <std::unsigned_integral T>
+auto node_bitmap(T num_nodes, std::predicate<T> auto keep) -> RankSelectBitmap {
+    auto bitmap = RankSelectBitmap(num_nodes);
+    for (T node = 0; node < num_nodes; ++node) {
+        if (keep(node))
+            bitmap.set(node);
+    }
+    bitmap.build_index();
+    return bitmap;
+}
+
+// Produces the subgraph of a node stream induced by the nodes set in a bitmap. Kept nodes are
+// renumbered by their rank among the kept nodes, so that they keep their relative order and the
+// successor lists stay sorted. The source is read in a single pass, and only the current list is
+// kept besides the bitmap. Use select() on the bitmap to map nodes of the subgraph back.
+template <std::unsigned_integral T, NodeStream<T> S>
+class SubgraphStream {
+    public:
+        struct Node {
+            T index;
+            std::span<const T> neighbours;
+        };
+
+    private:
+        S& source;
+        const RankSelectBitmap& kept;
+        std::vector<T> current;
+
+    public:
+        SubgraphStream(S& source, const RankSelectBitmap& kept);
+
+        auto next_node() -> std::optional<Node>;
+
+        inline auto num_nodes() const -> T {
+            return this->kept.count();
+        }
+};
+
+template <std::unsigned_integral T, NodeStream<T> S>
+SubgraphStream<T, S>::SubgraphStream(S& source, const RankSelectBitmap& kept):
+    source(source), kept(kept) {}
+
+template <std::unsigned_integral T, NodeStream<T> S>
+auto SubgraphStream<T, S>::next_node() -> std::optional<Node> {
+    while (auto node = this->source.next_node()) {
+        if (node->index >= this->kept.size())
+            throw EncodingException("Node ", node->index, " out of bounds of the subgraph bitmap");
+        if (!this->kept.test(node->index))
+            continue;
+
+        this->current.clear();
+        for (auto neighbour : node->neighbours) {
+            if (neighbour < this->kept.size() && this->kept.test(neighbour))
+                this->current.push_back(this->kept.rank(neighbour));
+        }
+        return {{T(this->kept.rank(node->index)), this->current}};
+    }
+
+    return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef _JORMUNGANDR_GRAPH_TRANSPOSE_HPP
+#define _JORMUNGANDR_GRAPH_TRANSPOSE_HPP
+
+#include "graph/graph.hpp"
+#include "decode/decoder.hpp"
+#include "exceptions.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <span>
+#include <queue>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <concepts>
+
+template <std::unsigned_integral T>
+auto transpose(const Graph<T>& graph, size_t threads) -> Graph<T> {
+    size_t n = graph.num_nodes();
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(n, 1));
+
+    // Every thread counts the in-degrees of the arcs of its own range of sources
+    auto ranges = std::vector<std::pair<size_t, size_t>>(threads);
+    auto histograms = std::vector<std::vector<size_t>>(threads);
+    parallel_for_range(0, threads, threads, [&](size_t first_thread, size_t last_thread) {
+        for (size_t t = first_thread; t < last_thread; ++t) {
+            size_t first = n * t / threads;
+            size_t last = n * (t + 1) / threads;
+            ranges[t] = {first, last};
+
+            auto& histogram = histograms[t];
+            histogram.resize(n, 0);
+            for (size_t u = first; u < last; ++u) {
+                for (auto v : graph.neighbours(u))
+                    ++histogram[v];
+            }
+        }
+    });
+
+    auto nodes = std::vector<typename Graph<T>::Node>(n, {0, 0});
+    parallel_for_range(0, n, threads, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            for (const auto& histogram : histograms)
+                nodes[v].num_edges += histogram[v];
+        }
+    });
+
+    size_t offset = 0;
+    for (auto& node : nodes) {
+        node.first_edge = offset;
+        offset += node.num_edges;
+    }
+
+    // Turn the histograms into the offset at which every thread starts writing for each node.
+    // As sources are partitioned in increasing order, the resulting lists are sorted.
+    parallel_for_range(0, n, threads, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            size_t position = nodes[v].first_edge;
+            for (auto& histogram : histograms) {
+                size_t count = histogram[v];
+                histogram[v] = position;
+                position += count;
+            }
+        }
+    });
+
+    auto edges = std::vector<T>(offset);
+    parallel_for_range(0, threads, threads, [&](size_t first_thread, size_t last_thread) {
+        for (size_t t = first_thread; t < last_thread; ++t) {
+            auto& positions = histograms[t];
+            for (size_t u = ranges[t].first; u < ranges[t].second; ++u) {
+                for (auto v : graph.neighbours(u))
+                    edges[positions[v]++] = u;
+            }
+        }
+    });
+
+    return Graph<T>(std::move(nodes), std::move(edges));
+}
+
+// Transposes a stream of successor lists using bounded memory: reversed arcs are collected in
+// batches of at most batch_arcs, which are sorted and spilled to temporary files. The transposed
+// lists are then produced in node order by merging these runs.
+template <std::unsigned_integral T>
+class ExternalTranspose {
+    public:
+        struct Node {
+            T index;
+            std::span<const T> neighbours;
+        };
+
+    private:
+        // Reversed arc, as (target, source)
+        using Arc = std::pair<T, T>;
+
+        struct Run {
+            std::filesystem::path path;
+            std::ifstream input;
+            std::vector<Arc> buffer;
+            size_t offset = 0;
+        };
+
+        constexpr const static size_t run_buffer_arcs = 1 << 16;
+
+        T total_nodes;
+        T next_node_index;
+        std::filesystem::path temp_dir;
+        std::vector<std::unique_ptr<Run>> runs;
+        std::priority_queue<std::pair<Arc, size_t>, std::vector<std::pair<Arc, size_t>>, std::greater<>> heap;
+        std::vector<T> current;
+
+    public:
+        template <NodeStream<T> S>
+        ExternalTranspose(S& source, T num_nodes, size_t batch_arcs = 1 << 24,
+                          const std::filesystem::path& temp_dir = std::filesystem::temp_directory_path());
+        ~ExternalTranspose();
+
+        ExternalTranspose(const ExternalTranspose&) = delete;
+        ExternalTranspose& operator=(const ExternalTranspose&) = delete;
+
+        auto next_node() -> std::optional<Node>;
+
+        inline auto num_nodes() const -> T {
+            return this->total_nodes;
+        }
+
+    private:
+        auto spill(std::vector<Arc>& batch) -> void;
+        auto advance(size_t run) -> void;
+        auto remove_runs() -> void;
+};
+
+template <std::unsigned_integral T>
+template <NodeStream<T> S>
+ExternalTranspose<T>::ExternalTranspose(S& source, T num_nodes, size_t batch_arcs,
+                                        const std::filesystem::path& temp_dir):
+    total_nodes(num_nodes), next_node_index(0), temp_dir(temp_dir) {
+    batch_arcs = std::max<size_t>(batch_arcs, 1);
+
+    // The destructor does not run if the constructor throws, so remove the runs written so far here
+    try {
+        auto batch = std::vector<Arc>();
+        batch.reserve(batch_arcs);
+        while (auto node = source.next_node()) {
+            for (auto neighbour : node->neighbours) {
+                batch.emplace_back(neighbour, node->index);
+                if (batch.size() == batch_arcs) {
+                    std::sort(batch.begin(), batch.end());
+                    this->spill(batch);
+                }
+            }
+        }
+
+        // The last batch does not need to be written out
+        std::sort(batch.begin(), batch.end());
+        auto last = std::make_unique<Run>();
+        last->buffer = std::move(batch);
+        this->runs.push_back(std::move(last));
+
+        for (size_t i = 0; i < this->runs.size(); ++i) {
+            auto& run = *this->runs[i];
+            if (!run.path.empty()) {
+                run.input.open(run.path, std::ios::binary);
+                if (!run.input)
+                    throw IoException("Failed to open temporary file ", run.path);
+                run.offset = run.buffer.size();
+            }
+            this->advance(i);
+        }
+    } catch (...) {
+        this->remove_runs();
+        throw;
+    }
+}
+
+template <std::unsigned_integral T>
+ExternalTranspose<T>::~ExternalTranspose() {
+    this->remove_runs();
+}
+
+template <std::unsigned_integral T>
+auto ExternalTranspose<T>::remove_runs() -> void {
+    for (auto& run : this->runs) {
+        if (!run->path.empty()) {
+            run->input.close();
+            auto ec = std::error_code();
+            std::filesystem::remove(run->path, ec);
+        }
+    }
+}
+
+template <std::unsigned_integral T>
+auto ExternalTranspose<T>::next_node() -> std::optional<Node> {
+    if (this->next_node_index >= this->total_nodes)
+        return std::nullopt;
+
+    T index = this->next_node_index++;
+    this->current.clear();
+    while (!this->heap.empty() && this->heap.top().first.first == index) {
+        auto [arc, run] = this->heap.top();
+        this->heap.pop();
+        this->current.push_back(arc.second);
+        this->advance(run);
+    }
+
+    if (this->next_node_index == this->total_nodes && !this->heap.empty())
+        throw EncodingException("Arc target out of bounds");
+
+    return {{index, this->current}};
+}
+
+template <std::unsigned_integral T>
+auto ExternalTranspose<T>::spill(std::vector<Arc>& batch) -> void {
+    auto run = std::make_unique<Run>();
+    auto rng = std::random_device();
+    run->path = this->temp_dir / make_msg("jormungandr-transpose-", rng(), rng(), "-", this->runs.size());
+    // Added before writing, so that a partially written file is removed as well
+    auto& path = this->runs.emplace_back(std::move(run))->path;
+
+    auto output = std::ofstream(path, std::ios::binary);
+    if (!output)
+        throw IoException("Failed to create temporary file ", path);
+    output.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Arc));
+    if (!output)
+        throw IoException("Failed to write temporary file ", path);
+
+    batch.clear();
+}
+
+template <std::unsigned_integral T>
+auto ExternalTranspose<T>::advance(size_t index) -> void {
+    auto& run = *this->runs[index];
+    if (run.offset == run.buffer.size()) {
+        if (run.path.empty())
+            return;
+
+        run.buffer.resize(run_buffer_arcs);
+        run.input.read(reinterpret_cast<char*>(run.buffer.data()), run_buffer_arcs * sizeof(Arc));
+        run.buffer.resize(run.input.gcount() / sizeof(Arc));
+        run.offset = 0;
+        if (run.buffer.empty())
+            return;
+    }
+
+    this->heap.emplace(run.buffer[run.offset++], index);
+}
+
+#endif
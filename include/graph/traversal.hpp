@@ -0,0 +1,267 @@
+#ifndef _JORMUNGANDR_GRAPH_TRAVERSAL_HPP
+#define _JORMUNGANDR_GRAPH_TRAVERSAL_HPP
+
+#include "parallel.hpp"
+
+#include <vector>
+#include <atomic>
+#include <ranges>
+#include <limits>
+#include <bit>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+
+// A graph of which the successors of any node can be listed, such as a Graph or an EliasFanoGraph
+template <typename G, typename T>
+concept RandomAccessGraph = std::unsigned_integral<T> && requires(const G& graph, T node) {
+    { graph.num_nodes() } -> std::convertible_to<size_t>;
+    { graph.neighbours(node) } -> std::ranges::sized_range;
+};
+
+// Level synchronous breadth-first search. Given the transposed graph as well, levels of which the
+// frontier has many outgoing arcs compared to the arcs left to explore are expanded bottom-up:
+// every unvisited node then looks for a predecessor in the frontier, instead of the other way
+// around, which avoids inspecting most arcs into already visited nodes.
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+class BreadthFirstSearch {
+    public:
+        constexpr const static T unreachable = std::numeric_limits<T>::max();
+
+    private:
+        // Bitmap with one bit per node
+        using Bitmap = std::vector<uint64_t>;
+
+        const G& graph;
+        const G* transposed;
+        size_t threads;
+
+        // Switch to bottom-up when the frontier has more than 1 / alpha of the unexplored arcs,
+        // and back to top-down once it has fewer than 1 / beta of the nodes
+        double alpha = 14;
+        double beta = 24;
+
+        size_t levels;
+        size_t bottom_up_levels;
+        // Number of arcs into the nodes of every word of the bitmap, to balance bottom-up levels by
+        std::vector<size_t> word_in_arcs;
+
+    public:
+        BreadthFirstSearch(const G& graph, size_t threads = default_thread_count());
+        BreadthFirstSearch(const G& graph, const G& transposed, size_t threads = default_thread_count());
+
+        // The distance of every node from source, or unreachable
+        auto run(T source) -> std::vector<T>;
+
+        // The number of levels of the last run, and how many of those were expanded bottom-up
+        inline auto num_levels() const -> size_t {
+            return this->levels;
+        }
+
+        inline auto num_bottom_up_levels() const -> size_t {
+            return this->bottom_up_levels;
+        }
+
+    private:
+        struct Frontier {
+            size_t nodes = 0;
+            size_t arcs = 0;
+        };
+
+        auto top_down(const Bitmap& frontier, Bitmap& next, std::vector<T>& distances, T level) -> Frontier;
+        auto bottom_up(const Bitmap& frontier, Bitmap& next, std::vector<T>& distances, T level) -> Frontier;
+};
+
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+BreadthFirstSearch<T, G>::BreadthFirstSearch(const G& graph, size_t threads):
+    graph(graph), transposed(nullptr), threads(threads), levels(0), bottom_up_levels(0) {}
+
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+BreadthFirstSearch<T, G>::BreadthFirstSearch(const G& graph, const G& transposed, size_t threads):
+    graph(graph), transposed(&transposed), threads(threads), levels(0), bottom_up_levels(0) {}
+
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+auto BreadthFirstSearch<T, G>::run(T source) -> std::vector<T> {
+    size_t n = this->graph.num_nodes();
+    auto distances = std::vector<T>(n, unreachable);
+    this->levels = 0;
+    this->bottom_up_levels = 0;
+    if (source >= n)
+        return distances;
+
+    size_t total_arcs = 0;
+    for (size_t node = 0; node < n; ++node)
+        total_arcs += std::ranges::size(this->graph.neighbours(node));
+
+    size_t words = (n + 63) / 64;
+    if (this->transposed) {
+        this->word_in_arcs.assign(words, 0);
+        for (size_t node = 0; node < n; ++node)
+            this->word_in_arcs[node / 64] += std::ranges::size(this->transposed->neighbours(node));
+    }
+
+    auto frontier = Bitmap(words, 0);
+    auto next = Bitmap(words, 0);
+    frontier[source / 64] |= uint64_t(1) << (source % 64);
+    distances[source] = 0;
+
+    auto current = Frontier{1, std::ranges::size(this->graph.neighbours(source))};
+    size_t unexplored_arcs = total_arcs - current.arcs;
+    bool bottom_up = false;
+    for (T level = 0; current.nodes > 0; ++level) {
+        ++this->levels;
+        if (this->transposed) {
+            if (!bottom_up && current.arcs * this->alpha > unexplored_arcs)
+                bottom_up = true;
+            else if (bottom_up && current.nodes * this->beta < n)
+                bottom_up = false;
+        }
+
+        std::fill(next.begin(), next.end(), 0);
+        if (bottom_up) {
+            ++this->bottom_up_levels;
+            current = this->bottom_up(frontier, next, distances, level);
+        } else {
+            current = this->top_down(frontier, next, distances, level);
+        }
+
+        unexplored_arcs -= std::min(unexplored_arcs, current.arcs);
+        std::swap(frontier, next);
+    }
+
+    return distances;
+}
+
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+auto BreadthFirstSearch<T, G>::top_down(const Bitmap& frontier, Bitmap& next, std::vector<T>& distances,
+                                        T level) -> Frontier {
+    auto counts = std::vector<Frontier>(std::max<size_t>(this->threads, 1));
+    // The frontier nodes of a word, and the arcs out of them
+    auto weight = [&](size_t word) {
+        size_t arcs = 0;
+        for (uint64_t bits = frontier[word]; bits != 0; bits &= bits - 1)
+            arcs += std::ranges::size(this->graph.neighbours(word * 64 + std::countr_zero(bits)));
+        return std::popcount(frontier[word]) + arcs + 1;
+    };
+    parallel_for_weighted(0, frontier.size(), this->threads, weight, [&](size_t thread, size_t first, size_t last) {
+        auto& count = counts[thread];
+        for (size_t word = first; word < last; ++word) {
+            for (uint64_t bits = frontier[word]; bits != 0; bits &= bits - 1) {
+                T node = word * 64 + std::countr_zero(bits);
+                for (auto successor : this->graph.neighbours(node)) {
+                    auto distance = std::atomic_ref(distances[successor]);
+                    T expected = unreachable;
+                    if (distance.load(std::memory_order_relaxed) != unreachable ||
+                        !distance.compare_exchange_strong(expected, level + 1, std::memory_order_relaxed))
+                        continue;
+
+                    std::atomic_ref(next[successor / 64]).fetch_or(uint64_t(1) << (successor % 64),
+                                                                   std::memory_order_relaxed);
+                    ++count.nodes;
+                    count.arcs += std::ranges::size(this->graph.neighbours(successor));
+                }
+            }
+        }
+    });
+
+    auto total = Frontier();
+    for (const auto& count : counts) {
+        total.nodes += count.nodes;
+        total.arcs += count.arcs;
+    }
+    return total;
+}
+
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+auto BreadthFirstSearch<T, G>::bottom_up(const Bitmap& frontier, Bitmap& next, std::vector<T>& distances,
+                                         T level) -> Frontier {
+    size_t n = distances.size();
+    auto counts = std::vector<Frontier>(std::max<size_t>(this->threads, 1));
+    auto weight = [&](size_t word) {
+        return this->word_in_arcs[word] + 64;
+    };
+    // Every thread owns whole words of the bitmap, so no synchronization is needed
+    parallel_for_weighted(0, frontier.size(), this->threads, weight, [&](size_t thread, size_t first, size_t last) {
+        auto& count = counts[thread];
+        for (size_t node = first * 64; node < std::min(last * 64, n); ++node) {
+            if (distances[node] != unreachable)
+                continue;
+
+            for (auto predecessor : this->transposed->neighbours(node)) {
+                if (frontier[predecessor / 64] & (uint64_t(1) << (predecessor % 64))) {
+                    distances[node] = level + 1;
+                    next[node / 64] |= uint64_t(1) << (node % 64);
+                    ++count.nodes;
+                    count.arcs += std::ranges::size(this->graph.neighbours(node));
+                    break;
+                }
+            }
+        }
+    });
+
+    auto total = Frontier();
+    for (const auto& count : counts) {
+        total.nodes += count.nodes;
+        total.arcs += count.arcs;
+    }
+    return total;
+}
+
+// Label every node with the smallest node of its weakly connected component. The arcs are merged
+// into a concurrent union-find forest, in which roots are always linked to smaller roots.
+template <std::unsigned_integral T, RandomAccessGraph<T> G>
+auto connected_components(const G& graph, size_t threads = default_thread_count()) -> std::vector<T> {
+    size_t n = graph.num_nodes();
+    auto parents = std::vector<T>(n);
+    for (size_t node = 0; node < n; ++node)
+        parents[node] = node;
+
+    auto find = [&](T node) {
+        while (true) {
+            T parent = std::atomic_ref(parents[node]).load(std::memory_order_relaxed);
+            if (parent == node)
+                return node;
+
+            // Path halving
+            T grandparent = std::atomic_ref(parents[parent]).load(std::memory_order_relaxed);
+            if (grandparent != parent)
+                std::atomic_ref(parents[node]).compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            node = grandparent;
+        }
+    };
+
+    auto weight = [&](size_t node) {
+        return std::ranges::size(graph.neighbours(node)) + 1;
+    };
+    parallel_for_weighted(0, n, threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t node = first; node < last; ++node) {
+            for (auto successor : graph.neighbours(node)) {
+                T a = node;
+                T b = successor;
+                while (true) {
+                    a = find(a);
+                    b = find(b);
+                    if (a == b)
+                        break;
+                    if (a < b)
+                        std::swap(a, b);
+
+                    // Fails when a is no longer a root, in which case both are looked up again
+                    T expected = a;
+                    if (std::atomic_ref(parents[a]).compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                        break;
+                }
+            }
+        }
+    });
+
+    auto components = std::vector<T>(n);
+    parallel_for_range(0, n, threads, [&](size_t first, size_t last) {
+        for (size_t node = first; node < last; ++node)
+            components[node] = find(node);
+    });
+
+    return components;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef _JORMUNGANDR_GRAPH_TRIANGLES_HPP
+#define _JORMUNGANDR_GRAPH_TRIANGLES_HPP
+
+#include "graph/graph.hpp"
+#include "graph/intersect.hpp"
+#include "graph/transpose.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <span>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+
+// Counts the triangles of a graph, taken as undirected and without self loops. Every edge is
+// oriented from the endpoint of lower degree to the one of higher degree, so that each triangle
+// is found exactly once, from its lowest ranked node, by intersecting two oriented lists.
+// High degree nodes keep short oriented lists this way. The work is split into tasks of
+// consecutive oriented arcs of roughly equal cost, which idle threads steal from each other, so
+// that the arcs of a single hub can be spread over several threads.
+template <std::unsigned_integral T>
+class TriangleCounter {
+    private:
+        Graph<T> oriented;
+        // Offset of the oriented list of every node, followed by the number of oriented arcs
+        std::vector<size_t> offsets;
+        // Degree of every node in the undirected graph
+        std::vector<T> degrees;
+        // Bounds of the ranges of oriented arcs handed out as tasks
+        std::vector<size_t> task_bounds;
+        size_t threads;
+
+    public:
+        TriangleCounter(const Graph<T>& graph, size_t threads = default_thread_count());
+
+        auto count() const -> uint64_t;
+        // The number of triangles every node is part of
+        auto count_per_node() const -> std::vector<uint64_t>;
+        // For every node, the fraction of pairs of its neighbours that are adjacent
+        auto clustering_coefficients() const -> std::vector<double>;
+
+        inline auto undirected_degrees() const -> std::span<const T> {
+            return this->degrees;
+        }
+
+    private:
+        auto orient(const Graph<T>& graph) -> void;
+        auto split_tasks() -> void;
+        // Call f(u, v, successors of u, successors of v) for every oriented arc, in parallel
+        auto for_each_arc(auto f) const -> void;
+};
+
+template <std::unsigned_integral T>
+TriangleCounter<T>::TriangleCounter(const Graph<T>& graph, size_t threads):
+    threads(std::max<size_t>(threads, 1)) {
+    this->orient(graph);
+    this->split_tasks();
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::orient(const Graph<T>& graph) -> void {
+    size_t n = graph.num_nodes();
+    auto transposed = transpose(graph, this->threads);
+
+    // The neighbours of u in the undirected graph are its successors and predecessors
+    auto for_each_neighbour = [&](size_t u, auto f) {
+        auto out = graph.neighbours(u);
+        auto in = transposed.neighbours(u);
+        auto i = out.begin();
+        auto j = in.begin();
+        while (i != out.end() || j != in.end()) {
+            T v;
+            if (j == in.end() || (i != out.end() && *i < *j)) {
+                v = *i++;
+            } else if (i == out.end() || *j < *i) {
+                v = *j++;
+            } else {
+                v = *i++;
+                ++j;
+            }
+
+            if (v != u)
+                f(v);
+        }
+    };
+
+    auto weight = [&](size_t u) {
+        return graph.neighbours(u).size() + transposed.neighbours(u).size() + 1;
+    };
+
+    this->degrees.assign(n, 0);
+    parallel_for_weighted(0, n, this->threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t u = first; u < last; ++u)
+            for_each_neighbour(u, [&](T) {
+                ++this->degrees[u];
+            });
+    });
+
+    auto ranks_before = [&](size_t u, size_t v) {
+        return this->degrees[u] < this->degrees[v] || (this->degrees[u] == this->degrees[v] && u < v);
+    };
+
+    auto nodes = std::vector<typename Graph<T>::Node>(n, {0, 0});
+    parallel_for_weighted(0, n, this->threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t u = first; u < last; ++u)
+            for_each_neighbour(u, [&](T v) {
+                nodes[u].num_edges += ranks_before(u, v);
+            });
+    });
+
+    this->offsets.resize(n + 1);
+    size_t offset = 0;
+    for (size_t u = 0; u < n; ++u) {
+        this->offsets[u] = offset;
+        nodes[u].first_edge = offset;
+        offset += nodes[u].num_edges;
+    }
+    this->offsets[n] = offset;
+
+    auto edges = std::vector<T>(offset);
+    parallel_for_weighted(0, n, this->threads, weight, [&](size_t, size_t first, size_t last) {
+        for (size_t u = first; u < last; ++u) {
+            size_t position = this->offsets[u];
+            for_each_neighbour(u, [&](T v) {
+                if (ranks_before(u, v))
+                    edges[position++] = v;
+            });
+        }
+    });
+
+    this->oriented = Graph<T>(std::move(nodes), std::move(edges));
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::split_tasks() -> void {
+    // An intersection takes time linear in the length of both lists
+    size_t n = this->oriented.num_nodes();
+    size_t total_cost = 0;
+    for (size_t u = 0; u < n; ++u) {
+        size_t out = this->oriented.neighbours(u).size();
+        for (auto v : this->oriented.neighbours(u))
+            total_cost += out + this->oriented.neighbours(v).size() + 1;
+    }
+
+    // Several tasks per thread, so that threads which finish early can take over
+    size_t task_cost = std::max<size_t>(total_cost / (this->threads * tasks_per_thread * 4), 1024);
+    size_t cost = 0;
+    this->task_bounds = {0};
+    for (size_t u = 0; u < n; ++u) {
+        size_t out = this->oriented.neighbours(u).size();
+        size_t arc = this->offsets[u];
+        for (auto v : this->oriented.neighbours(u)) {
+            cost += out + this->oriented.neighbours(v).size() + 1;
+            ++arc;
+            if (cost >= task_cost) {
+                this->task_bounds.push_back(arc);
+                cost = 0;
+            }
+        }
+    }
+
+    if (this->task_bounds.back() < this->offsets[n])
+        this->task_bounds.push_back(this->offsets[n]);
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::for_each_arc(auto f) const -> void {
+    parallel_for_tasks(this->task_bounds, this->threads, [&](size_t, size_t first_arc, size_t last_arc) {
+        // The node of which the oriented list contains the first arc
+        size_t u = std::upper_bound(this->offsets.begin(), this->offsets.end(), first_arc) - this->offsets.begin() - 1;
+        for (size_t arc = first_arc; arc < last_arc; ++arc) {
+            while (arc >= this->offsets[u + 1])
+                ++u;
+
+            auto out = this->oriented.neighbours(u);
+            T v = out[arc - this->offsets[u]];
+            f(u, v, out, this->oriented.neighbours(v));
+        }
+    });
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::count() const -> uint64_t {
+    auto total = std::atomic<uint64_t>(0);
+    this->for_each_arc([&](T, T, std::span<const T> a, std::span<const T> b) {
+        if (auto triangles = intersection_size(a, b))
+            total.fetch_add(triangles, std::memory_order_relaxed);
+    });
+    return total;
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::count_per_node() const -> std::vector<uint64_t> {
+    auto counts = std::vector<uint64_t>(this->oriented.num_nodes(), 0);
+    auto add = [&](T node) {
+        std::atomic_ref(counts[node]).fetch_add(1, std::memory_order_relaxed);
+    };
+
+    this->for_each_arc([&](T u, T v, std::span<const T> a, std::span<const T> b) {
+        for_each_common(a, b, [&](T w) {
+            add(u);
+            add(v);
+            add(w);
+        });
+    });
+    return counts;
+}
+
+template <std::unsigned_integral T>
+auto TriangleCounter<T>::clustering_coefficients() const -> std::vector<double> {
+    auto counts = this->count_per_node();
+    auto coefficients = std::vector<double>(counts.size(), 0);
+    for (size_t u = 0; u < counts.size(); ++u) {
+        double degree = this->degrees[u];
+        if (degree >= 2)
+            coefficients[u] = counts[u] / (degree * (degree - 1) / 2);
+    }
+    return coefficients;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef _JORMUNGANDR_INSTRUMENTATION_HPP
+#define _JORMUNGANDR_INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Counters and timers of the hot paths of the codec, which are only compiled in when the
+// instrumentation meson option is enabled, and which otherwise cost nothing. Every thread counts
+// on its own, and its counts are added to those of the process when it exits. The totals are
+// reported to stderr at exit, or to the file named by JORMUNGANDR_INSTRUMENTATION_REPORT.
+enum class Counter : size_t {
+    BITREADER_REFILLS,
+    BITREADER_BYTES_READ,
+    // Calls of read_unary, which include those by the codes built on unary
+    BITREADER_UNARY_SCANS,
+    // Codes read, where a delta code counts its gamma code as well, and a zeta or golomb code its
+    // minimal binary code
+    BITREADER_GAMMA_CODES,
+    BITREADER_DELTA_CODES,
+    BITREADER_ZETA_CODES,
+    BITREADER_GOLOMB_CODES,
+    BITREADER_NIBBLE_CODES,
+    BITREADER_PRED_SIZE_CODES,
+    BITREADER_MINIMAL_BINARY_CODES,
+    DECODER_NODES,
+    DECODER_SKIPPED_NODES,
+    DECODER_COPIED_ARCS,
+    DECODER_INTERVAL_ARCS,
+    DECODER_RESIDUAL_ARCS,
+    DECODER_MERGES,
+    DECODER_MERGED_ARCS,
+    ENCODER_NODES,
+    ENCODER_WINDOW_CANDIDATES,
+    ENCODER_SKETCH_COMPARISONS,
+    ENCODER_INTERSECTIONS,
+    ENCODER_INTERSECTED_ARCS,
+    COUNT
+};
+
+enum class Timer : size_t {
+    BITREADER_REFILL,
+    DECODER_MERGE,
+    ENCODER_REFERENCE_SEARCH,
+    COUNT
+};
+
+auto counter_name(Counter counter) -> std::string_view;
+auto timer_name(Timer timer) -> std::string_view;
+
+struct ThreadCounters {
+    uint64_t counts[size_t(Counter::COUNT)];
+    uint64_t timer_ns[size_t(Timer::COUNT)];
+    bool registered;
+};
+
+// Zero initialized, so that accessing it needs no initialization check
+inline constinit thread_local ThreadCounters thread_counters = {};
+
+// Make sure the counts of the calling thread are added to the totals when it exits
+auto register_thread_counters() -> void;
+
+inline auto add_count(Counter counter, uint64_t n = 1) -> void {
+    if (!thread_counters.registered) [[unlikely]]
+        register_thread_counters();
+    thread_counters.counts[size_t(counter)] += n;
+}
+
+// Adds the time from its construction to its destruction to a timer
+class ScopedTimer {
+    private:
+        Timer timer;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ScopedTimer(Timer timer): timer(timer), start(std::chrono::steady_clock::now()) {}
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - this->start).count();
+            if (!thread_counters.registered)
+                register_thread_counters();
+            thread_counters.timer_ns[size_t(this->timer)] += ns;
+        }
+};
+
+#ifdef JORMUNGANDR_INSTRUMENTATION
+#define JORMUNGANDR_COUNT(counter, n) add_count(Counter::counter, (n))
+#define JORMUNGANDR_TIME(timer) auto jormungandr_scoped_timer = ScopedTimer(Timer::timer)
+#else
+#define JORMUNGANDR_COUNT(counter, n) ((void) 0)
+#define JORMUNGANDR_TIME(timer) ((void) 0)
+#endif
+
+#endif
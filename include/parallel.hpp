@@ -0,0 +1,210 @@
+#ifndef _JORMUNGANDR_PARALLEL_HPP
+#define _JORMUNGANDR_PARALLEL_HPP
+
+#include <thread>
+#include <vector>
+#include <span>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+template <typename F>
+concept RangeCallback = std::invocable<F, size_t, size_t>;
+
+// Called as f(thread, first, last), where thread is the index of the calling thread
+template <typename F>
+concept TaskCallback = std::invocable<F, size_t, size_t, size_t>;
+
+template <typename F>
+concept WeightCallback = std::invocable<F, size_t> && std::convertible_to<std::invoke_result_t<F, size_t>, size_t>;
+
+// The number of tasks every thread starts with in parallel_for_weighted, to leave idle threads
+// something to steal
+constexpr const size_t tasks_per_thread = 16;
+
+inline auto default_thread_count() -> size_t {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+// Split [begin, end) into one contiguous range per thread, and call f(first, last) for each of them.
+// Exceptions thrown by f are rethrown once all threads have stopped.
+auto parallel_for_range(size_t begin, size_t end, size_t threads, RangeCallback auto f) -> void {
+    size_t total = end > begin ? end - begin : 0;
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(total, 1));
+    if (threads == 1) {
+        f(begin, end);
+        return;
+    }
+
+    auto error = std::exception_ptr();
+    auto error_mutex = std::mutex();
+    auto work = [&](size_t first, size_t last) {
+        try {
+            f(first, last);
+        } catch (...) {
+            auto lock = std::lock_guard(error_mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    auto workers = std::vector<std::thread>();
+    size_t per_thread = total / threads;
+    size_t remainder = total % threads;
+    size_t first = begin;
+    for (size_t i = 0; i < threads; ++i) {
+        size_t last = first + per_thread + (i < remainder ? 1 : 0);
+        workers.emplace_back(work, first, last);
+        first = last;
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Split [begin, end) into at most parts consecutive ranges of roughly equal total weight, and
+// return their bounds. A single item heavier than a part gets a range of its own.
+auto split_by_weight(size_t begin, size_t end, size_t parts, WeightCallback auto weight) -> std::vector<size_t> {
+    auto bounds = std::vector<size_t>{begin};
+    if (end <= begin)
+        return bounds;
+
+    size_t total = 0;
+    for (size_t i = begin; i < end; ++i)
+        total += weight(i);
+
+    parts = std::max<size_t>(parts, 1);
+    size_t sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += weight(i);
+        // Start a new range once the weight so far reaches the next multiple of total / parts
+        if (i + 1 < end && sum * parts >= total * bounds.size())
+            bounds.push_back(i + 1);
+    }
+
+    bounds.push_back(end);
+    return bounds;
+}
+
+// Call f(thread, first, last) for each range between consecutive bounds. Every thread starts with
+// a contiguous share of the ranges, which it takes from the front. Once its share is done, it
+// steals ranges from the back of the shares of the other threads. Exceptions thrown by f are
+// rethrown once all threads have stopped.
+auto parallel_for_tasks(std::span<const size_t> bounds, size_t threads, TaskCallback auto f) -> void {
+    size_t tasks = bounds.size() > 1 ? bounds.size() - 1 : 0;
+    assert(tasks <= UINT32_MAX);
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(tasks, 1));
+    if (threads == 1) {
+        for (size_t task = 0; task < tasks; ++task)
+            f(0, bounds[task], bounds[task + 1]);
+        return;
+    }
+
+    // The remaining tasks of every share, as the first task in the low and the end in the high
+    // half, so that both ends are updated together
+    struct alignas(64) Share {
+        std::atomic<uint64_t> tasks;
+    };
+    auto pack = [](uint64_t first, uint64_t last) {
+        return first | (last << 32);
+    };
+
+    auto shares = std::vector<Share>(threads);
+    for (size_t t = 0; t < threads; ++t)
+        shares[t].tasks = pack(tasks * t / threads, tasks * (t + 1) / threads);
+
+    auto take_front = [&](Share& share) -> std::optional<size_t> {
+        uint64_t current = share.tasks.load(std::memory_order_relaxed);
+        while ((current & UINT32_MAX) < (current >> 32)) {
+            if (share.tasks.compare_exchange_weak(current, current + 1, std::memory_order_relaxed))
+                return current & UINT32_MAX;
+        }
+        return std::nullopt;
+    };
+    auto take_back = [&](Share& share) -> std::optional<size_t> {
+        uint64_t current = share.tasks.load(std::memory_order_relaxed);
+        while ((current & UINT32_MAX) < (current >> 32)) {
+            uint64_t last = (current >> 32) - 1;
+            if (share.tasks.compare_exchange_weak(current, pack(current & UINT32_MAX, last), std::memory_order_relaxed))
+                return last;
+        }
+        return std::nullopt;
+    };
+
+    auto error = std::exception_ptr();
+    auto error_mutex = std::mutex();
+    auto work = [&](size_t thread) {
+        try {
+            while (auto task = take_front(shares[thread]))
+                f(thread, bounds[*task], bounds[*task + 1]);
+
+            // Shares never grow, so a round in which nothing could be stolen means all tasks are taken
+            bool stole = true;
+            while (stole) {
+                stole = false;
+                for (size_t i = 1; i < threads; ++i) {
+                    while (auto task = take_back(shares[(thread + i) % threads])) {
+                        f(thread, bounds[*task], bounds[*task + 1]);
+                        stole = true;
+                    }
+                }
+            }
+        } catch (...) {
+            auto lock = std::lock_guard(error_mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    auto workers = std::vector<std::thread>();
+    for (size_t t = 1; t < threads; ++t)
+        workers.emplace_back(work, t);
+    work(0);
+
+    for (auto& worker : workers)
+        worker.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Split [begin, end) by the weight of every item, and call f(thread, first, last) for the
+// resulting ranges using work stealing
+auto parallel_for_weighted(size_t begin, size_t end, size_t threads, WeightCallback auto weight,
+                           TaskCallback auto f) -> void {
+    threads = std::max<size_t>(threads, 1);
+    size_t parts = threads > 1 ? threads * tasks_per_thread : 1;
+    auto bounds = split_by_weight(begin, end, parts, weight);
+    parallel_for_tasks(bounds, threads, f);
+}
+
+// Call f(state, i) for every i in [begin, end), where state is the state of the calling thread,
+// created by make_state(thread) before any work starts. Returns the states of all threads, so
+// that their results can be combined.
+auto parallel_for_each_weighted(size_t begin, size_t end, size_t threads, WeightCallback auto weight,
+                                std::invocable<size_t> auto make_state, auto f) {
+    using State = std::invoke_result_t<decltype(make_state), size_t>;
+    threads = std::max<size_t>(threads, 1);
+    auto states = std::vector<State>();
+    states.reserve(threads);
+    for (size_t t = 0; t < threads; ++t)
+        states.push_back(make_state(t));
+
+    parallel_for_weighted(begin, end, threads, weight, [&](size_t thread, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+            f(states[thread], i);
+    });
+    return states;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _JORMUNGANDR_PROGRESS_HPP
+#define _JORMUNGANDR_PROGRESS_HPP
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <cstdint>
+
+struct Progress {
+    uint64_t nodes;
+    // Zero if unknown
+    uint64_t total_nodes;
+    // Zero if not counted
+    uint64_t arcs;
+    // Read or written
+    uint64_t bytes;
+    double seconds;
+    // Since the previous report, so that a drop in throughput shows right away
+    double nodes_per_second;
+    double bytes_per_second;
+    // From the average rate so far, if the total is known
+    std::optional<double> eta_seconds;
+    bool finished;
+};
+
+using ProgressCallback = std::function<void(const Progress&)>;
+
+// Passes the progress of a long running job to a callback, at most once per interval. Decoders and
+// encoders call update() from their buffer refills and flushes rather than for every node, so
+// that reporting costs nothing in the per node path.
+class ProgressReporter {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        ProgressCallback callback;
+        clock::duration interval;
+        clock::time_point start;
+        clock::time_point last_report;
+        uint64_t last_nodes;
+        uint64_t last_bytes;
+
+    public:
+        ProgressReporter(ProgressCallback callback, clock::duration interval = std::chrono::seconds(1));
+
+        // Report if the interval has passed since the last report
+        auto update(uint64_t nodes, uint64_t total_nodes, uint64_t arcs, uint64_t bytes) -> void;
+        // Report the final counts, regardless of the interval
+        auto finish(uint64_t nodes, uint64_t total_nodes, uint64_t arcs, uint64_t bytes) -> void;
+
+    private:
+        auto report(clock::time_point now, uint64_t nodes, uint64_t total_nodes, uint64_t arcs, uint64_t bytes,
+                    bool finished) -> void;
+};
+
+// A callback printing every report as a line on stderr, starting with label
+auto print_progress(std::string label) -> ProgressCallback;
+
+#endif
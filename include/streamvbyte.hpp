@@ -0,0 +1,28 @@
+#ifndef _JORMUNGANDR_STREAMVBYTE_HPP
+#define _JORMUNGANDR_STREAMVBYTE_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+// Stream VByte: 32-bit integers are stored in 1 to 4 little-endian bytes, of which the lengths
+// are kept in a separate stream of control bytes, one per group of four integers. As the
+// lengths of a whole group are known up front, a group can be decoded with a single shuffle.
+
+// Bytes that may be read past the end of the data when decoding with SIMD instructions
+constexpr const size_t streamvbyte_padding = 16;
+
+inline auto streamvbyte_control_bytes(size_t count) -> size_t {
+    return (count + 3) / 4;
+}
+
+// Append the encoding of values to control and data
+auto streamvbyte_encode(std::span<const uint32_t> values, std::vector<uint8_t>& control, std::vector<uint8_t>& data) -> void;
+// Decode count values, starting at a group boundary, and return the end of the data read. The
+// data must be followed by at least streamvbyte_padding readable bytes.
+auto streamvbyte_decode(const uint8_t* control, const uint8_t* data, size_t count, uint32_t* out) -> const uint8_t*;
+// The number of data bytes used by the first count values
+auto streamvbyte_data_bytes(const uint8_t* control, size_t count) -> size_t;
+
+#endif
@@ -8,12 +8,18 @@
 #include <algorithm>
 #include <numeric>
 #include <type_traits>
+#include <cstdint>
 
 template <typename T>
 consteval auto bit_size_of() -> size_t {
     return sizeof(T) * CHAR_BIT;
 }
 
+// 2^n, wrapping around to 0 for n = 64 so that differences such as 2^64 - z stay correct
+constexpr auto power_of_two(uint64_t n) -> uint64_t {
+    return n < bit_size_of<uint64_t>() ? uint64_t(1) << n : 0;
+}
+
 template <typename... Args>
 auto make_msg(const Args&... args) {
     std::stringstream ss;
@@ -0,0 +1,287 @@
+#include <iostream>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <optional>
+#include <algorithm>
+#include <unordered_map>
+#include <variant>
+#include <limits>
+
+#include "decode/property.hpp"
+#include "decode/webgraph.hpp"
+#include "decode/sharded.hpp"
+#include "decode/eliasfano.hpp"
+#include "graph/eliasfano.hpp"
+#include "graph/transpose.hpp"
+#include "graph/traversal.hpp"
+#include "graph/pagerank.hpp"
+#include "graph/triangles.hpp"
+#include "decode/streaming.hpp"
+#include "parallel.hpp"
+
+enum class Analysis {
+    BFS,
+    WCC,
+    PAGERANK,
+    TRIANGLES
+};
+
+struct Options {
+    Analysis analysis;
+    std::string basename;
+    uint64_t source = 0;
+    size_t threads = default_thread_count();
+    bool compressed = false;
+    bool top_down = false;
+    PageRankOptions pagerank;
+    const char* output_file = NULL;
+};
+
+auto print_usage(const char* prog) -> void {
+    std::cerr << "Usage: " << prog << " [options] <bfs|wcc|pagerank|triangles> <graph basename>\n"
+        "options:\n"
+        "--source <int>: source node of the breadth-first search, 0 by default\n"
+        "--threads <int>\n"
+        "--compressed: run on the Elias-Fano representation of the graph instead of the decoded lists\n"
+        "--top-down: only expand the breadth-first search top-down, which does not need the transposed graph\n"
+        "--iterations <int>: maximum number of pagerank iterations\n"
+        "--damping <float>: pagerank damping factor\n"
+        "--tolerance <float>: stop pagerank once the ranks change less than this\n"
+        "--output <file>: write the distance, component, rank or triangles and clustering coefficient of every reached node as tsv\n"
+        "pagerank streams the graph from disk in every iteration instead of loading it, in parallel if it is chunked" << std::endl;
+}
+
+auto read_properties(const std::string& basename) -> PropertyMap {
+    auto prop_filename = basename + ".properties";
+    auto prop_input = std::ifstream(prop_filename);
+    if(!prop_input)
+        throw PropertyException("Failed to find property file ", prop_filename);
+    return PropertyParser(prop_input).decode();
+}
+
+// Reads a BVGraph, a sharded BVGraph or an Elias-Fano graph
+template <std::unsigned_integral T>
+auto load_graph(const std::string& basename) -> std::variant<Graph<T>, EliasFanoGraph<T>> {
+    auto prop_filename = basename + ".properties";
+    auto prop_input = std::ifstream(prop_filename);
+    if(!prop_input)
+        throw PropertyException("Failed to find property file ", prop_filename);
+    auto properties = PropertyParser(prop_input).decode();
+    prop_input.clear();
+    prop_input.seekg(0);
+
+    if(properties.maybe_as<size_t>("shards"))
+        return ShardedDecoder<T>(basename, prop_input).decode();
+
+    auto input = std::ifstream(basename + ".graph", std::ios::binary);
+    if(!input)
+        throw IoException("Failed to open graph file ", basename, ".graph");
+
+    if(properties.maybe_as<std::string>("graphclass") == "jormungandr.EliasFanoGraph")
+        return EliasFanoDecoder<T>(input, prop_input).decode();
+    return WebGraphDecoder<T>(input, prop_input).decode();
+}
+
+template <std::unsigned_integral T, typename G>
+auto run(const G& graph, const Options& options) -> void {
+    auto output = std::ofstream();
+    if(options.output_file) {
+        output.open(options.output_file);
+        if(!output)
+            throw IoException("Failed to create output file ", options.output_file);
+    }
+
+    switch(options.analysis) {
+        case Analysis::BFS: {
+            auto transposed = std::optional<G>();
+            if(!options.top_down) {
+                if constexpr(std::is_same_v<G, Graph<T>>)
+                    transposed.emplace(transpose(graph, options.threads));
+                else
+                    transposed.emplace(transpose(graph.to_graph(), options.threads));
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto bfs = transposed ?
+                BreadthFirstSearch<T, G>(graph, *transposed, options.threads) :
+                BreadthFirstSearch<T, G>(graph, options.threads);
+            auto distances = bfs.run(options.source);
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            auto reached = std::count_if(distances.begin(), distances.end(), [](auto distance) {
+                return distance != BreadthFirstSearch<T, G>::unreachable;
+            });
+            std::cerr << "reached " << reached << " nodes in " << bfs.num_levels() << " levels, of which "
+                << bfs.num_bottom_up_levels() << " bottom-up, in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms" << std::endl;
+
+            if(output.is_open()) {
+                for(size_t node = 0; node < distances.size(); ++node) {
+                    if(distances[node] != BreadthFirstSearch<T, G>::unreachable)
+                        output << node << '\t' << distances[node] << '\n';
+                }
+            }
+            break;
+        }
+        case Analysis::WCC: {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto components = connected_components<T>(graph, options.threads);
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            auto sizes = std::unordered_map<T, size_t>();
+            for(auto component : components)
+                ++sizes[component];
+            size_t largest = 0;
+            for(auto [component, size] : sizes)
+                largest = std::max(largest, size);
+
+            std::cerr << sizes.size() << " components, the largest of which has " << largest << " nodes, in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms" << std::endl;
+
+            if(output.is_open()) {
+                for(size_t node = 0; node < components.size(); ++node)
+                    output << node << '\t' << components[node] << '\n';
+            }
+            break;
+        }
+        case Analysis::TRIANGLES: {
+            if constexpr(std::is_same_v<G, Graph<T>>) {
+                auto start = std::chrono::high_resolution_clock::now();
+                auto counter = TriangleCounter<T>(graph, options.threads);
+                auto triangles = counter.count();
+                auto stop = std::chrono::high_resolution_clock::now();
+                std::cerr << triangles << " triangles in "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms" << std::endl;
+
+                if(output.is_open()) {
+                    auto counts = counter.count_per_node();
+                    auto coefficients = counter.clustering_coefficients();
+                    for(size_t node = 0; node < counts.size(); ++node)
+                        output << node << '\t' << counts[node] << '\t' << coefficients[node] << '\n';
+                }
+            } else {
+                throw EncodingException("Triangle counting requires the decoded graph");
+            }
+            break;
+        }
+        case Analysis::PAGERANK:
+            break;
+    }
+}
+
+template <std::unsigned_integral T>
+auto run_pagerank(const Options& options) -> void {
+    auto output = std::ofstream();
+    if(options.output_file) {
+        output.open(options.output_file);
+        if(!output)
+            throw IoException("Failed to create output file ", options.output_file);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto graph = StreamingGraph<T>(options.basename, options.threads);
+    auto result = pagerank(graph, options.pagerank);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    auto top = std::max_element(result.ranks.begin(), result.ranks.end());
+    std::cerr << result.iterations << " iterations using " << graph.num_threads() << " threads, error "
+        << result.error << ", in " << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count()
+        << " ms" << std::endl;
+    if(top != result.ranks.end())
+        std::cerr << "highest rank " << *top << " for node " << top - result.ranks.begin() << std::endl;
+
+    if(output.is_open()) {
+        output.precision(17);
+        for(size_t node = 0; node < result.ranks.size(); ++node)
+            output << node << '\t' << result.ranks[node] << '\n';
+    }
+}
+
+template <std::unsigned_integral T>
+auto analyze(const Options& options) -> void {
+    if(options.analysis == Analysis::PAGERANK) {
+        run_pagerank<T>(options);
+        return;
+    }
+
+    auto graph = load_graph<T>(options.basename);
+    if(options.compressed && std::holds_alternative<Graph<T>>(graph))
+        graph = EliasFanoGraph<T>(std::get<Graph<T>>(graph));
+
+    std::visit([&](const auto& graph) {
+        if(options.analysis == Analysis::BFS && options.source >= graph.num_nodes())
+            throw EncodingException("Source node ", options.source, " out of bounds");
+        run<T>(graph, options);
+    }, graph);
+}
+
+auto main(int argc, char* argv[]) -> int {
+    try {
+        auto options = Options();
+        const char* analysis = NULL;
+        const char* basename = NULL;
+
+        for(int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if(!std::strcmp(arg, "--source") && has_value)
+                options.source = std::stoull(argv[++i]);
+            else if(!std::strcmp(arg, "--threads") && has_value)
+                options.threads = std::max<size_t>(std::stoull(argv[++i]), 1);
+            else if(!std::strcmp(arg, "--iterations") && has_value)
+                options.pagerank.max_iterations = std::stoull(argv[++i]);
+            else if(!std::strcmp(arg, "--damping") && has_value)
+                options.pagerank.damping = std::stod(argv[++i]);
+            else if(!std::strcmp(arg, "--tolerance") && has_value)
+                options.pagerank.tolerance = std::stod(argv[++i]);
+            else if(!std::strcmp(arg, "--output") && has_value)
+                options.output_file = argv[++i];
+            else if(!std::strcmp(arg, "--compressed"))
+                options.compressed = true;
+            else if(!std::strcmp(arg, "--top-down"))
+                options.top_down = true;
+            else if(analysis == NULL)
+                analysis = arg;
+            else if(basename == NULL)
+                basename = arg;
+            else {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        if(!analysis || !basename) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if(!std::strcmp(analysis, "bfs"))
+            options.analysis = Analysis::BFS;
+        else if(!std::strcmp(analysis, "wcc"))
+            options.analysis = Analysis::WCC;
+        else if(!std::strcmp(analysis, "pagerank"))
+            options.analysis = Analysis::PAGERANK;
+        else if(!std::strcmp(analysis, "triangles"))
+            options.analysis = Analysis::TRIANGLES;
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        options.basename = basename;
+
+        // Only use 64-bit nodes for graphs that need them
+        if(read_properties(options.basename).as<uint64_t>("nodes") > std::numeric_limits<uint32_t>::max())
+            analyze<uint64_t>(options);
+        else
+            analyze<uint32_t>(options);
+
+        return EXIT_SUCCESS;
+    } catch(const std::runtime_error& err) {
+        std::cerr << "Exception occurred: " << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
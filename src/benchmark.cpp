@@ -1,33 +1,377 @@
 #include "decode/webgraph.hpp"
+#include "decode/chunks.hpp"
 #include "encode/webgraph.hpp"
 #include "encode/property.hpp"
+#include "encode/chunks.hpp"
+#include "graph/eliasfano.hpp"
+#include "graph/triangles.hpp"
+#include "graph/generator.hpp"
+#include "streamvbyte.hpp"
+#include "decode/streamvbyte.hpp"
+#include "decode/view.hpp"
+#include "encode/streamvbyte.hpp"
 #include "encoding.hpp"
+#include "exceptions.hpp"
+#include "parallel.hpp"
 
+#include <sys/resource.h>
+
+#include <atomic>
 #include <chrono>
+#include <random>
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <concepts>
+#include <type_traits>
+#include <new>
+#include <limits>
+#include <optional>
 #include <cstdlib>
 
-using node_type = uint32_t;
-
 constexpr const std::string_view usage =
-    "Usage: either of\n"
-    "benchmark encode [encode options] <input basename> <output basename>\n"
-    "benchmark decode <input basename>\n"
-    "where [encode options] may consist of:\n"
+    "Usage: benchmark [harness options] <operation>, where <operation> is either of\n"
+    "encode [encode options] <input basename> <output basename>\n"
+    "decode <input basename>\n"
+    "degrees <input basename>\n"
+    "decode-chunks <input basename> [threads]\n"
+    "ef-queries <input basename> [queries]\n"
+    "streamvbyte <input basename>\n"
+    "triangles <input basename> [threads]\n"
+    "generate [generator options] <output basename>\n"
+    "The operation is run --warmup times untimed and then --repetitions times, and the median time\n"
+    "in ns is printed. Statistics per phase are printed to stderr. Graphs with more nodes than fit in\n"
+    "32 bits use 64-bit node ids.\n"
+    "[harness options] may consist of:\n"
+    "--warmup <int>: 1 by default\n"
+    "--repetitions <int>: 5 by default\n"
+    "--json <file>: also write all statistics to file as json\n"
+    "[encode options] may consist of:\n"
     "--window-size <int>\n"
     "--zeta-k <int>\n"
     "--pred-size <int>\n"
     "--min-interval-size <int>\n"
-    "--max-ref-count <int>\n";
+    "--max-ref-count <int>\n"
+    "--sketch-candidates <int>\n"
+    "--sketch-size <int>\n"
+    "--chunk-nodes <int>\n"
+    "--chunk-bytes <int>\n"
+    "--outdegree-code <code>\n"
+    "--block-code <code>\n"
+    "--residual-code <code>\n"
+    "where <code> is one of DELTA, GAMMA, UNARY, ZETA, GOLOMB or NIBBLE\n"
+    "[generator options] may consist of:\n"
+    "--model <model>: one of RMAT, COPYING, ERDOS_RENYI or CONFIGURATION, COPYING by default\n"
+    "--nodes <int>\n"
+    "--arcs <int>: expected number of arcs, before duplicates are removed\n"
+    "--seed <int>\n"
+    "--exponent <float>: of the power law degrees of COPYING and CONFIGURATION\n"
+    "--rmat-a <float>, --rmat-b <float>, --rmat-c <float>: quadrant probabilities of RMAT\n"
+    "--copy-probability <float>, --host-locality <float>, --host-size <int>: of COPYING";
+
+// Every allocation of the process goes through these, so the harness can count them per run. The
+// deletes are not inlined, as GCC would then warn about freeing memory from operator new.
+static std::atomic<uint64_t> allocation_count = 0;
+static std::atomic<uint64_t> allocated_bytes = 0;
+
+auto operator new(size_t size) -> void* {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] auto operator delete(void* p) noexcept -> void {
+    std::free(p);
+}
+
+[[gnu::noinline]] auto operator delete(void* p, size_t) noexcept -> void {
+    std::free(p);
+}
+
+struct HarnessOptions {
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    std::string json_file;
+};
+
+struct Statistics {
+    double median;
+    double p95;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+};
+
+auto statistics(std::vector<double> samples) -> Statistics {
+    std::sort(samples.begin(), samples.end());
+    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    double variance = 0;
+    for (auto sample : samples)
+        variance += (sample - mean) * (sample - mean);
+
+    size_t middle = samples.size() / 2;
+    double median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+    // Nearest rank, so that the p95 of few runs is the slowest run
+    size_t p95 = (samples.size() * 95 + 99) / 100 - 1;
+    return {median, samples[p95], mean, std::sqrt(variance / samples.size()), samples.front(), samples.back()};
+}
+
+// The time spent in every phase of a single run, in ns
+class Run {
+    private:
+        std::vector<std::pair<std::string, double>> phases;
+
+    public:
+        // Call f and add the time it took to the phase
+        template <std::invocable F>
+        auto phase(std::string_view name, F f) -> std::invoke_result_t<F> {
+            auto start = std::chrono::high_resolution_clock::now();
+            if constexpr (std::is_void_v<std::invoke_result_t<F>>) {
+                f();
+                this->record(name, start);
+            } else {
+                auto result = f();
+                this->record(name, start);
+                return result;
+            }
+        }
+
+        inline auto times() const -> const std::vector<std::pair<std::string, double>>& {
+            return this->phases;
+        }
+
+    private:
+        auto record(std::string_view name, std::chrono::high_resolution_clock::time_point start) -> void {
+            auto stop = std::chrono::high_resolution_clock::now();
+            double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+            auto it = std::find_if(this->phases.begin(), this->phases.end(), [&](const auto& phase) {
+                return phase.first == name;
+            });
+            if (it == this->phases.end())
+                this->phases.emplace_back(name, ns);
+            else
+                it->second += ns;
+        }
+};
+
+// Runs an operation repeatedly, and reports the distribution of the time of every phase, of the
+// whole run, and of the allocations per run. Operations report what they processed, such as
+// arcs and bytes, as counters, from which throughput and compression are derived.
+class Harness {
+    private:
+        HarnessOptions options;
+        std::string operation;
+        std::vector<std::string> arguments;
+        // In the order in which the phases first ran, with the whole run last
+        std::vector<std::string> phase_names;
+        std::map<std::string, std::vector<double>> samples;
+        std::vector<double> allocations;
+        std::vector<double> allocation_bytes;
+        std::map<std::string, double> counters;
+
+    public:
+        Harness(const HarnessOptions& options, std::string_view operation, int argc, const char* argv[]):
+            options(options), operation(operation), arguments(argv, argv + argc) {}
+
+        auto run(std::invocable<Run&> auto f) -> void {
+            for (size_t i = 0; i < this->options.warmup; ++i) {
+                auto run = Run();
+                f(run);
+            }
+
+            for (size_t i = 0; i < this->options.repetitions; ++i) {
+                auto run = Run();
+                uint64_t count_before = allocation_count.load();
+                uint64_t bytes_before = allocated_bytes.load();
+
+                auto start = std::chrono::high_resolution_clock::now();
+                f(run);
+                auto stop = std::chrono::high_resolution_clock::now();
+
+                this->allocations.push_back(allocation_count.load() - count_before);
+                this->allocation_bytes.push_back(allocated_bytes.load() - bytes_before);
+                for (const auto& [name, ns] : run.times())
+                    this->add_sample(name, ns);
+                this->add_sample("total", std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+            }
+        }
+
+        // Record what a run processed, which should be the same for every run
+        inline auto count(const std::string& name, double value) -> void {
+            this->counters[name] = value;
+        }
+
+        auto report() const -> void {
+            auto total = statistics(this->samples.at("total"));
+            std::cout << uint64_t(total.median) << std::endl;
+
+            std::cerr << std::setprecision(15) << "phase\tmedian_ns\tp95_ns\tstddev_ns\tmin_ns" << std::endl;
+            for (const auto& name : this->phase_names) {
+                auto s = statistics(this->samples.at(name));
+                std::cerr << name << '\t' << uint64_t(s.median) << '\t' << uint64_t(s.p95) << '\t'
+                          << uint64_t(s.stddev) << '\t' << uint64_t(s.min) << std::endl;
+            }
+            for (const auto& [name, value] : this->counters)
+                std::cerr << name << ": " << value << std::endl;
+            for (const auto& [name, value] : this->derived(total))
+                std::cerr << name << ": " << value << std::endl;
+            std::cerr << "peak_rss_bytes: " << peak_rss() << ", allocations: " << statistics(this->allocations).median
+                      << ", allocated_bytes: " << statistics(this->allocation_bytes).median << std::endl;
+
+            if (!this->options.json_file.empty()) {
+                auto out = std::ofstream(this->options.json_file);
+                if (!out)
+                    throw IoException("Failed to create ", this->options.json_file);
+                this->write_json(out, total);
+            }
+        }
+
+    private:
+        auto add_sample(const std::string& name, double ns) -> void {
+            if (!this->samples.contains(name))
+                this->phase_names.push_back(name);
+            this->samples[name].push_back(ns);
+        }
+
+        auto derived(const Statistics& total) const -> std::vector<std::pair<std::string, double>> {
+            auto result = std::vector<std::pair<std::string, double>>();
+            auto arcs = this->counters.find("arcs");
+            if (arcs != this->counters.end()) {
+                result.emplace_back("arcs_per_second", arcs->second * 1e9 / std::max(total.median, 1.0));
+                auto bytes = this->counters.find("bytes");
+                if (bytes != this->counters.end() && arcs->second > 0)
+                    result.emplace_back("bits_per_arc", bytes->second * 8 / arcs->second);
+            }
+            return result;
+        }
+
+        static auto peak_rss() -> uint64_t {
+            auto usage = rusage();
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+                return 0;
+            // In KiB on Linux
+            return uint64_t(usage.ru_maxrss) * 1024;
+        }
 
-auto encode(int argc, const char* argv[]) -> int {
+        static auto json_string(std::string_view str) -> std::string {
+            auto result = std::string("\"");
+            for (char c : str) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                    result += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    auto escaped = std::ostringstream();
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c);
+                    result += escaped.str();
+                } else {
+                    result += c;
+                }
+            }
+            return result + '"';
+        }
+
+        static auto write_json(std::ostream& out, const std::vector<double>& samples) -> void {
+            auto s = statistics(samples);
+            out << "{\"median\": " << s.median << ", \"p95\": " << s.p95 << ", \"mean\": " << s.mean
+                << ", \"stddev\": " << s.stddev << ", \"min\": " << s.min << ", \"max\": " << s.max
+                << ", \"samples\": [";
+            for (size_t i = 0; i < samples.size(); ++i)
+                out << (i ? ", " : "") << samples[i];
+            out << "]}";
+        }
+
+        auto write_json(std::ostream& out, const Statistics& total) const -> void {
+            out << std::setprecision(15);
+            out << "{\n  \"operation\": " << json_string(this->operation) << ",\n  \"arguments\": [";
+            for (size_t i = 0; i < this->arguments.size(); ++i)
+                out << (i ? ", " : "") << json_string(this->arguments[i]);
+            out << "],\n  \"warmup\": " << this->options.warmup
+                << ",\n  \"repetitions\": " << this->options.repetitions << ",\n  \"phases_ns\": {";
+            for (size_t i = 0; i < this->phase_names.size(); ++i) {
+                out << (i ? "," : "") << "\n    " << json_string(this->phase_names[i]) << ": ";
+                write_json(out, this->samples.at(this->phase_names[i]));
+            }
+            out << "\n  },\n  \"counters\": {";
+            bool first = true;
+            for (const auto& [name, value] : this->counters) {
+                out << (first ? "" : ",") << "\n    " << json_string(name) << ": " << value;
+                first = false;
+            }
+            for (const auto& [name, value] : this->derived(total)) {
+                out << (first ? "" : ",") << "\n    " << json_string(name) << ": " << value;
+                first = false;
+            }
+            out << "\n  },\n  \"peak_rss_bytes\": " << peak_rss() << ",\n  \"allocations\": ";
+            write_json(out, this->allocations);
+            out << ",\n  \"allocated_bytes\": ";
+            write_json(out, this->allocation_bytes);
+            out << "\n}" << std::endl;
+        }
+};
+
+auto open_input(const std::string& basename, const char* extension) -> std::ifstream {
+    auto in = std::ifstream(basename + extension, std::ios::binary);
+    if (!in)
+        throw IoException("Unable to open input ", basename, extension);
+    return in;
+}
+
+// Read a whole file into memory, so that decoding can be timed apart from reading
+auto read_file(const std::string& basename, const char* extension) -> std::string {
+    auto in = open_input(basename, extension);
+    auto contents = std::ostringstream();
+    contents << in.rdbuf();
+    return std::move(contents).str();
+}
+
+auto write_file(const std::string& basename, const char* extension, std::stringstream& contents) -> void {
+    auto out = std::ofstream(basename + extension, std::ios::binary);
+    if (!out || !(out << contents.rdbuf()))
+        throw IoException("Failed to write output ", basename, extension);
+}
+
+template <std::unsigned_integral T>
+auto load_graph(const std::string& basename) -> Graph<T> {
+    auto in = open_input(basename, ".graph");
+    auto in_props = open_input(basename, ".properties");
+    return WebGraphDecoder<T>(in, in_props).decode();
+}
+
+template <std::unsigned_integral T>
+auto count_arcs(const Graph<T>& graph) -> size_t {
+    size_t arcs = 0;
+    graph.for_each([&](T, std::span<const T> neighbours) {
+        arcs += neighbours.size();
+    });
+    return arcs;
+}
+
+template <std::unsigned_integral T>
+auto encode(Harness& harness, int argc, const char* argv[]) -> int {
     uint32_t window_size = 7;
     uint32_t zeta_k = 3;
     uint32_t min_interval_size = 2;
     uint32_t max_ref_count = 3;
     uint32_t pred_size = 4;
+    uint32_t sketch_candidates = 0;
+    uint32_t sketch_size = 16;
+    uint32_t chunk_nodes = 0;
+    uint32_t chunk_bytes = 0;
+    auto defaults = EncodingConfig();
+    Encoding outdegree_code = defaults.outdegree_encoding;
+    Encoding block_code = defaults.copy_block_encoding;
+    Encoding residual_code = defaults.residual_encoding;
 
     const char* in_basename = nullptr;
     const char* out_basename = nullptr;
@@ -35,6 +379,7 @@ auto encode(int argc, const char* argv[]) -> int {
     for (int i = 0; i < argc; ++i) {
         auto arg = std::string_view(argv[i]);
         uint32_t* int_arg = nullptr;
+        Encoding* code_arg = nullptr;
 
         if (arg == "--window-size")
             int_arg = &window_size;
@@ -46,6 +391,20 @@ auto encode(int argc, const char* argv[]) -> int {
             int_arg = &min_interval_size;
         else if (arg == "--max-ref-count")
             int_arg = &max_ref_count;
+        else if (arg == "--sketch-candidates")
+            int_arg = &sketch_candidates;
+        else if (arg == "--sketch-size")
+            int_arg = &sketch_size;
+        else if (arg == "--chunk-nodes")
+            int_arg = &chunk_nodes;
+        else if (arg == "--chunk-bytes")
+            int_arg = &chunk_bytes;
+        else if (arg == "--outdegree-code")
+            code_arg = &outdegree_code;
+        else if (arg == "--block-code")
+            code_arg = &block_code;
+        else if (arg == "--residual-code")
+            code_arg = &residual_code;
         else if (!in_basename) {
             in_basename = argv[i];
             continue;
@@ -63,102 +422,432 @@ auto encode(int argc, const char* argv[]) -> int {
             return EXIT_FAILURE;
         }
 
-        *int_arg = static_cast<uint32_t>(std::stoull(argv[i]));
+        if (code_arg)
+            *code_arg = encoding_from_string(argv[i]);
+        else
+            *int_arg = static_cast<uint32_t>(std::stoull(argv[i]));
+    }
+
+    if (!in_basename || !out_basename) {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
     }
 
-    auto in_basename_str = std::string(in_basename);
-    auto in = std::ifstream(in_basename_str + ".graph", std::ios::binary);
+    auto graph = load_graph<T>(in_basename);
+    harness.count("arcs", count_arcs(graph));
 
-    if (!in) {
-        std::cerr << "Error: Unable to open input .graph" << std::endl;
+    auto encoding_config = EncodingConfig{
+        .copy_block_encoding = block_code,
+        .outdegree_encoding = outdegree_code,
+        .residual_encoding = residual_code,
+        .residual_encoding_start = residual_code,
+        .zeta_k = zeta_k,
+        .min_interval_size = min_interval_size,
+        .window_size = window_size,
+        .max_ref_count = max_ref_count,
+        .pred_size = pred_size,
+        .sketch_candidates = sketch_candidates,
+        .sketch_size = sketch_size,
+        .chunk_nodes = chunk_nodes,
+        .chunk_bytes = chunk_bytes
+    };
+
+    // Everything is encoded to memory first, so that writing the files is a phase of its own
+    auto out_basename_str = std::string(out_basename);
+    harness.run([&](Run& run) {
+        auto out = std::stringstream();
+        auto out_props = std::stringstream();
+        auto out_chunks = std::stringstream();
+
+        auto encoder = WebGraphEncoder(out, encoding_config, graph);
+        auto props = run.phase("encode", [&]() {
+            return encoder.encode();
+        });
+        run.phase("properties", [&]() {
+            PropertyEncoder(out_props).encode(props);
+            if (encoding_config.is_chunked())
+                ChunkIndexEncoder(out_chunks).encode(encoder.chunk_index());
+        });
+        harness.count("bytes", out.tellp());
+
+        run.phase("write", [&]() {
+            write_file(out_basename_str, ".graph", out);
+            write_file(out_basename_str, ".properties", out_props);
+            if (encoding_config.is_chunked())
+                write_file(out_basename_str, ".chunks", out_chunks);
+        });
+    });
+
+    return EXIT_SUCCESS;
+}
+
+template <std::unsigned_integral T>
+auto decode(Harness& harness, int argc, const char* argv[]) -> int {
+    if (argc != 1) {
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto in_props = std::ifstream(in_basename_str + ".properties", std::ios::binary);
-    if (!in_props) {
-        std::cerr << "Error: Unable to open input .properties" << std::endl;
+    auto in_basename = std::string(argv[0]);
+    harness.run([&](Run& run) {
+        auto in = run.phase("read", [&]() {
+            return std::istringstream(read_file(in_basename, ".graph"));
+        });
+        auto in_props = std::istringstream(read_file(in_basename, ".properties"));
+        harness.count("bytes", in.view().size());
+
+        // Just iterate through all nodes to make the library load the graph
+        auto arcs = run.phase("decode", [&]() {
+            size_t arcs = 0;
+            auto decoder = WebGraphDecoder<T>(in, in_props);
+            while (auto node = decoder.next_node())
+                arcs += node->neighbours.size();
+            return arcs;
+        });
+        harness.count("arcs", arcs);
+    });
+
+    return EXIT_SUCCESS;
+}
+
+template <std::unsigned_integral T>
+auto degrees(Harness& harness, int argc, const char* argv[]) -> int {
+    if (argc != 1) {
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto graph = WebGraphDecoder<node_type>(in, in_props).decode();
+    auto in_basename = std::string(argv[0]);
+    harness.run([&](Run& run) {
+        auto in = run.phase("read", [&]() {
+            return std::istringstream(read_file(in_basename, ".graph"));
+        });
+        auto in_props = std::istringstream(read_file(in_basename, ".properties"));
+        harness.count("bytes", in.view().size());
+
+        // Only the outdegrees are required, so the successor lists need not be decoded
+        auto arcs = run.phase("decode", [&]() {
+            size_t arcs = 0;
+            auto decoder = WebGraphDecoder<T>(in, in_props);
+            while (auto out_degree = decoder.skip_node(WebGraphDecoder<T>::SkipMode::DEGREES_ONLY))
+                arcs += *out_degree;
+            return arcs;
+        });
+        harness.count("arcs", arcs);
+    });
 
-    auto start = std::chrono::high_resolution_clock::now();
+    return EXIT_SUCCESS;
+}
 
-    auto out_basename_str = std::string(out_basename);
-    auto out = std::ofstream(out_basename_str + ".graph", std::ios::binary);
-    if (!out) {
-        std::cerr << "Error: Failed to create output .graph" << std::endl;
+template <std::unsigned_integral T>
+auto decode_chunks(Harness& harness, int argc, const char* argv[]) -> int {
+    if (argc != 1 && argc != 2) {
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto out_props = std::ofstream(out_basename_str + ".properties", std::ios::binary);
-    if (!out) {
-        std::cerr << "Error: Failed to create output .properties" << std::endl;
+    size_t threads = argc == 2 ? std::max<size_t>(std::stoull(argv[1]), 1) : default_thread_count();
+
+    auto in_basename = std::string(argv[0]);
+    auto in_props = open_input(in_basename, ".properties");
+    auto in_chunks = open_input(in_basename, ".chunks");
+
+    auto properties = PropertyParser(in_props).decode();
+    auto num_nodes = properties.as<T>("nodes");
+    auto encoding_config = EncodingConfig::from_properties(properties);
+    auto chunks = ChunkIndexDecoder(in_chunks).decode();
+    harness.count("chunks", chunks.size());
+
+    harness.run([&](Run& run) {
+        // Every thread decodes its own range of chunks from its own stream
+        auto thread_arcs = std::vector<size_t>(std::max<size_t>(chunks.size(), 1), 0);
+        run.phase("decode", [&]() {
+            parallel_for_range(0, chunks.size(), threads, [&](size_t first, size_t last) {
+                auto in = open_input(in_basename, ".graph");
+                for (size_t chunk = first; chunk < last; ++chunk) {
+                    auto decoder = WebGraphDecoder<T>::for_chunk(in, chunks, chunk, num_nodes, encoding_config);
+                    while (auto node = decoder.next_node())
+                        thread_arcs[first] += node->neighbours.size();
+                }
+            });
+        });
+        harness.count("arcs", std::accumulate(thread_arcs.begin(), thread_arcs.end(), size_t(0)));
+    });
+
+    return EXIT_SUCCESS;
+}
+
+template <std::unsigned_integral T>
+auto ef_queries(Harness& harness, int argc, const char* argv[]) -> int {
+    if (argc != 1 && argc != 2) {
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto encoding_config = EncodingConfig{
-        .zeta_k = zeta_k,
-        .min_interval_size = min_interval_size,
-        .window_size = window_size,
-        .max_ref_count = max_ref_count,
-        .pred_size = pred_size
-    };
+    size_t queries = argc == 2 ? std::stoull(argv[1]) : 1000000;
 
-    auto props = WebGraphEncoder(out, encoding_config, graph).encode();
-    PropertyEncoder(out_props).encode(props);
+    auto graph = EliasFanoGraph<T>(load_graph<T>(argv[0]));
+    if (graph.num_arcs() == 0) {
+        std::cerr << "Error: Graph has no arcs" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Query random arcs, and random pairs of nodes which are mostly not connected. They are drawn
+    // up front, so that the random number generator is not timed and every run queries the same.
+    struct Query {
+        T node;
+        size_t successor;
+        T target;
+    };
+    auto rng = std::mt19937_64(0);
+    auto nodes = std::uniform_int_distribution<T>(0, graph.num_nodes() - 1);
+    auto query_list = std::vector<Query>();
+    query_list.reserve(queries);
+    while (query_list.size() < queries) {
+        auto node = nodes(rng);
+        if (graph.outdegree(node) > 0)
+            query_list.push_back({node, rng() % graph.outdegree(node), nodes(rng)});
+    }
+    harness.count("queries", queries * 3);
 
-    auto stop = std::chrono::high_resolution_clock::now();
-    std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() << std::endl;
+    harness.run([&](Run& run) {
+        auto found = run.phase("queries", [&]() {
+            size_t found = 0;
+            for (const auto& query : query_list) {
+                auto successor = graph.successor(query.node, query.successor);
+                found += graph.has_arc(query.node, successor);
+                found += graph.has_arc(query.node, query.target);
+            }
+            return found;
+        });
+        harness.count("arcs_found", found);
+    });
 
     return EXIT_SUCCESS;
 }
 
-auto decode(int argc, const char* argv[]) -> int {
+template <std::unsigned_integral T>
+auto streamvbyte(Harness& harness, int argc, const char* argv[]) -> int {
     if (argc != 1) {
         std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto start = std::chrono::high_resolution_clock::now();
+    auto graph = load_graph<T>(argv[0]);
+    auto encoded = std::stringstream();
+    auto props = std::stringstream();
+    PropertyEncoder(props).encode(StreamVByteEncoder(encoded, graph).encode());
+    auto decoder = StreamVByteDecoder<T>(encoded, props);
+    harness.count("bytes", encoded.view().size());
 
-    auto in_basename = std::string(argv[0]);
-    auto in = std::ifstream(in_basename + ".graph", std::ios::binary);
-    if (!in) {
-        std::cerr << "Error: Unable to open input .graph" << std::endl;
+    harness.run([&](Run& run) {
+        // Sum the successors so that the decoding cannot be optimized away
+        size_t arcs = 0;
+        size_t checksum = 0;
+        run.phase("decode", [&]() {
+            decoder.rewind();
+            for (auto successors : successor_lists(decoder)) {
+                arcs += successors.size();
+                for (auto neighbour : successors)
+                    checksum += neighbour;
+            }
+        });
+        harness.count("arcs", arcs);
+        harness.count("checksum", checksum);
+    });
+
+    return EXIT_SUCCESS;
+}
+
+template <std::unsigned_integral T>
+auto triangles(Harness& harness, int argc, const char* argv[]) -> int {
+    if (argc != 1 && argc != 2) {
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto in_props = std::ifstream(in_basename + ".properties", std::ios::binary);
-    if (!in_props) {
-        std::cerr << "Error: Unable to open input .properties" << std::endl;
-        return EXIT_FAILURE;
+    size_t threads = argc == 2 ? std::max<size_t>(std::stoull(argv[1]), 1) : default_thread_count();
+
+    auto graph = load_graph<T>(argv[0]);
+    harness.count("arcs", count_arcs(graph));
+
+    harness.run([&](Run& run) {
+        auto counter = run.phase("orient", [&]() {
+            return TriangleCounter<T>(graph, threads);
+        });
+        auto triangles = run.phase("count", [&]() {
+            return counter.count();
+        });
+        harness.count("triangles", triangles);
+    });
+
+    return EXIT_SUCCESS;
+}
+
+template <std::unsigned_integral T>
+auto generate(Harness& harness, int argc, const char* argv[]) -> int {
+    auto config = GeneratorConfig();
+    const char* out_basename = nullptr;
+
+    for (int i = 0; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        if (!arg.starts_with("--")) {
+            if (out_basename) {
+                std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+                return EXIT_FAILURE;
+            }
+            out_basename = argv[i];
+            continue;
+        }
+
+        ++i;
+        if (i >= argc) {
+            std::cerr << "Error: Expected argument to " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (arg == "--model")
+            config.model = generator_model_from_string(argv[i]);
+        else if (arg == "--nodes")
+            config.num_nodes = std::stoull(argv[i]);
+        else if (arg == "--arcs")
+            config.num_arcs = std::stoull(argv[i]);
+        else if (arg == "--seed")
+            config.seed = std::stoull(argv[i]);
+        else if (arg == "--exponent")
+            config.exponent = std::stod(argv[i]);
+        else if (arg == "--rmat-a")
+            config.rmat_a = std::stod(argv[i]);
+        else if (arg == "--rmat-b")
+            config.rmat_b = std::stod(argv[i]);
+        else if (arg == "--rmat-c")
+            config.rmat_c = std::stod(argv[i]);
+        else if (arg == "--copy-probability")
+            config.copy_probability = std::stod(argv[i]);
+        else if (arg == "--host-locality")
+            config.host_locality = std::stod(argv[i]);
+        else if (arg == "--host-size")
+            config.mean_host_size = std::stoull(argv[i]);
+        else {
+            std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
     }
 
-    auto decoder = WebGraphDecoder<node_type>(in, in_props);
-    // Just iterate through all nodes to make the library load the graph
-    while (auto node = decoder.next_node()) {
-        continue;
+    if (!out_basename) {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
     }
 
-    auto stop = std::chrono::high_resolution_clock::now();
-    std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() << std::endl;
+    // The graph is streamed into the encoder, so it is never held in memory as a whole
+    auto out_basename_str = std::string(out_basename);
+    harness.run([&](Run& run) {
+        auto out = std::stringstream();
+        auto out_props = std::stringstream();
+        auto generator = GraphGenerator<T>(config);
+        auto encoder = WebGraphEncoder<T>(out, EncodingConfig());
+
+        size_t arcs = 0;
+        while (auto node = run.phase("generate", [&]() { return generator.next_node(); })) {
+            arcs += node->neighbours.size();
+            run.phase("encode", [&]() {
+                encoder.push_node(node->neighbours);
+            });
+        }
+        run.phase("properties", [&]() {
+            PropertyEncoder(out_props).encode(encoder.finish());
+        });
+        harness.count("nodes", generator.num_nodes());
+        harness.count("arcs", arcs);
+        harness.count("bytes", out.tellp());
+
+        run.phase("write", [&]() {
+            write_file(out_basename_str, ".graph", out);
+            write_file(out_basename_str, ".properties", out_props);
+        });
+    });
+
     return EXIT_SUCCESS;
 }
 
+// Graphs with more nodes than fit in 32 bits are benchmarked with 64-bit node ids, for which the
+// number of nodes is read from the properties of the input, or from the generator options
+auto node_bits(std::string_view operation, int argc, const char* argv[]) -> size_t {
+    auto nodes = std::optional<uint64_t>();
+    if (operation == "generate") {
+        for (int i = 0; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == "--nodes")
+                nodes = std::stoull(argv[i + 1]);
+        }
+    } else if (argc > 0) {
+        // The input of encode comes after its options
+        auto basename = std::string(operation == "encode" && argc >= 2 ? argv[argc - 2] : argv[0]);
+        auto in = std::ifstream(basename + ".properties");
+        if (in)
+            nodes = PropertyParser(in).decode().maybe_as<uint64_t>("nodes");
+    }
+    return nodes && *nodes > std::numeric_limits<uint32_t>::max() ? 64 : 32;
+}
+
+template <std::unsigned_integral T>
+auto run_operation(std::string_view operation, Harness& harness, int argc, const char* argv[]) -> int {
+    if (operation == "encode")
+        return encode<T>(harness, argc, argv);
+    if (operation == "decode")
+        return decode<T>(harness, argc, argv);
+    if (operation == "degrees")
+        return degrees<T>(harness, argc, argv);
+    if (operation == "decode-chunks")
+        return decode_chunks<T>(harness, argc, argv);
+    if (operation == "ef-queries")
+        return ef_queries<T>(harness, argc, argv);
+    if (operation == "streamvbyte")
+        return streamvbyte<T>(harness, argc, argv);
+    if (operation == "triangles")
+        return triangles<T>(harness, argc, argv);
+    if (operation == "generate")
+        return generate<T>(harness, argc, argv);
+
+    std::cerr << "Invalid operation: " << operation << std::endl;
+    return EXIT_FAILURE;
+}
+
 auto main(int argc, const char* argv[]) -> int {
-    if (argc < 2) {
+    auto options = HarnessOptions();
+    int i = 1;
+    // The harness options come before the operation, which parses the rest
+    for (; i + 1 < argc; i += 2) {
+        auto arg = std::string_view(argv[i]);
+        if (arg == "--warmup")
+            options.warmup = std::stoull(argv[i + 1]);
+        else if (arg == "--repetitions")
+            options.repetitions = std::max<size_t>(std::stoull(argv[i + 1]), 1);
+        else if (arg == "--json")
+            options.json_file = argv[i + 1];
+        else
+            break;
+    }
+
+    if (i >= argc) {
         std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
-    auto option = std::string_view(argv[1]);
-    if (option == "encode") {
-        return encode(argc - 2, argv + 2);
-    } else if (option == "decode") {
-        return decode(argc - 2, argv + 2);
-    } else {
-        std::cerr << "Invalid operation: " << option << std::endl;
+    auto option = std::string_view(argv[i]);
+    auto harness = Harness(options, option, argc - i - 1, argv + i + 1);
+    int result;
+    try {
+        if (node_bits(option, argc - i - 1, argv + i + 1) == 64)
+            result = run_operation<uint64_t>(option, harness, argc - i - 1, argv + i + 1);
+        else
+            result = run_operation<uint32_t>(option, harness, argc - i - 1, argv + i + 1);
+
+        if (result == EXIT_SUCCESS)
+            harness.report();
+    } catch (const std::runtime_error& err) {
+        std::cerr << "Error: " << err.what() << std::endl;
         return EXIT_FAILURE;
     }
+
+    return result;
 }
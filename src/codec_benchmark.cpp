@@ -0,0 +1,221 @@
+#include "decode/bitreader.hpp"
+#include "encode/bitwriter.hpp"
+#include "encoding.hpp"
+
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <concepts>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+constexpr const std::string_view usage =
+    "Usage: codec-benchmark [options]\n"
+    "Times writing and reading every instantaneous code on synthetic values, and prints a tsv row\n"
+    "per code, distribution and direction.\n"
+    "options:\n"
+    "--values <int>: values per repetition, 1048576 by default\n"
+    "--repetitions <int>: timed repetitions, 10 by default\n"
+    "--warmup <int>: untimed repetitions before the timed ones, 2 by default\n"
+    "--seed <int>\n"
+    "--code <name>: only time codes starting with name, such as zeta or golomb\n"
+    "--distribution <geometric|powerlaw|uniform>: only time this distribution";
+
+// Above this mean, unary codes would take too long to be worth timing
+constexpr const double max_unary_mean = 1024;
+
+struct Distribution {
+    std::string name;
+    std::function<uint64_t(std::mt19937_64&)> sample;
+};
+
+struct Timing {
+    double median;
+    double stddev;
+    double min;
+};
+
+auto distributions() -> std::vector<Distribution> {
+    return {
+        // Gaps between successors of nodes with a few dozen successors
+        {"geometric", [](std::mt19937_64& rng) -> uint64_t {
+            return std::geometric_distribution<uint64_t>(1.0 / 32)(rng);
+        }},
+        // Heavy tail with exponent 2.5, like outdegrees and residual gaps of web graphs
+        {"powerlaw", [](std::mt19937_64& rng) -> uint64_t {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            double value = std::pow(1 - u, -1 / 1.5) - 1;
+            return std::min<double>(value, 1 << 30);
+        }},
+        // Node ids of a graph with a million nodes
+        {"uniform", [](std::mt19937_64& rng) -> uint64_t {
+            return std::uniform_int_distribution<uint64_t>(0, (1 << 20) - 1)(rng);
+        }},
+    };
+}
+
+// Call f(name, write, read) for every code. The codes are passed as lambdas rather than through
+// std::function, so that the timed loops call them directly.
+auto for_each_code(const std::vector<uint64_t>& values, auto f) -> bool {
+    bool ok = f("gamma", [](BitWriter& w, uint64_t v) { w.write_gamma(v); },
+                [](BitReader& r) { return r.read_gamma(); }) &&
+        f("delta", [](BitWriter& w, uint64_t v) { w.write_delta(v); },
+          [](BitReader& r) { return r.read_delta(); });
+
+    for (uint64_t k = 1; k <= 7 && ok; ++k) {
+        ok = f("zeta" + std::to_string(k), [k](BitWriter& w, uint64_t v) { w.write_zeta(v, k); },
+               [k](BitReader& r) { return r.read_zeta(k); });
+    }
+
+    uint64_t b = golomb_parameter(std::accumulate(values.begin(), values.end(), uint64_t(0)), values.size());
+    ok = ok && f("golomb" + std::to_string(b), [b](BitWriter& w, uint64_t v) { w.write_golomb(v, b); },
+                 [b](BitReader& r) { return r.read_golomb(b); });
+    ok = ok && f("nibble", [](BitWriter& w, uint64_t v) { w.write_nibble(v); },
+                 [](BitReader& r) { return r.read_nibble(); });
+    ok = ok && f("pred_size", [](BitWriter& w, uint64_t v) { w.write_pred_size(v, 6); },
+                 [](BitReader& r) { return r.read_pred_size(6); });
+
+    double mean = values.empty() ? 0 : double(std::accumulate(values.begin(), values.end(), uint64_t(0))) / values.size();
+    if (mean <= max_unary_mean) {
+        ok = ok && f("unary", [](BitWriter& w, uint64_t v) { w.write_unary_with_terminator(v, 0); },
+                     [](BitReader& r) { return r.read_unary_with_terminator(0); });
+    }
+
+    return ok;
+}
+
+auto summarize(std::vector<double> samples) -> Timing {
+    std::sort(samples.begin(), samples.end());
+    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    double variance = 0;
+    for (auto sample : samples)
+        variance += (sample - mean) * (sample - mean);
+
+    size_t middle = samples.size() / 2;
+    double median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+    return {median, std::sqrt(variance / samples.size()), samples.front()};
+}
+
+// Run f warmup + repetitions times, and return the time per value of the timed runs in ns
+auto measure(size_t warmup, size_t repetitions, size_t values, std::invocable auto f) -> Timing {
+    for (size_t i = 0; i < warmup; ++i)
+        f();
+
+    auto samples = std::vector<double>();
+    for (size_t i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto stop = std::chrono::high_resolution_clock::now();
+        samples.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()) / values);
+    }
+    return summarize(samples);
+}
+
+auto print_row(const std::string& code, const std::string& distribution, const char* op, const Timing& timing,
+               double bits_per_value) -> void {
+    std::cout << code << '\t' << distribution << '\t' << op << '\t' << timing.median << '\t' << timing.stddev << '\t'
+              << timing.min << '\t' << 1e9 / timing.median << '\t' << bits_per_value << std::endl;
+}
+
+auto main(int argc, const char* argv[]) -> int {
+    size_t num_values = 1 << 20;
+    size_t repetitions = 10;
+    size_t warmup = 2;
+    uint64_t seed = 42;
+    auto code_filter = std::string();
+    auto distribution_filter = std::string();
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        bool has_value = i + 1 < argc;
+        if (arg == "--values" && has_value)
+            num_values = std::max<size_t>(std::stoull(argv[++i]), 1);
+        else if (arg == "--repetitions" && has_value)
+            repetitions = std::max<size_t>(std::stoull(argv[++i]), 1);
+        else if (arg == "--warmup" && has_value)
+            warmup = std::stoull(argv[++i]);
+        else if (arg == "--seed" && has_value)
+            seed = std::stoull(argv[++i]);
+        else if (arg == "--code" && has_value)
+            code_filter = argv[++i];
+        else if (arg == "--distribution" && has_value)
+            distribution_filter = argv[++i];
+        else {
+            std::cerr << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        std::cout << "code\tdistribution\top\tns_per_value\tstddev_ns\tmin_ns\tvalues_per_second\tbits_per_value" << std::endl;
+        for (const auto& distribution : distributions()) {
+            if (!distribution_filter.empty() && distribution.name != distribution_filter)
+                continue;
+
+            auto rng = std::mt19937_64(seed);
+            auto values = std::vector<uint64_t>(num_values);
+            for (auto& value : values)
+                value = distribution.sample(rng);
+
+            bool ok = for_each_code(values, [&](const std::string& name, auto write_value, auto read_value) {
+                if (name.compare(0, code_filter.size(), code_filter) != 0)
+                    return true;
+
+                // The output is written to memory, which is reused by every repetition, so that only the
+                // code is timed
+                auto output = std::ostringstream();
+                auto write = measure(warmup, repetitions, values.size(), [&]() {
+                    output.seekp(0);
+                    auto writer = BitWriter(output);
+                    for (auto value : values)
+                        write_value(writer, value);
+                });
+
+                auto expected = std::ostringstream();
+                uint64_t bits;
+                {
+                    auto writer = BitWriter(expected);
+                    for (auto value : values)
+                        write_value(writer, value);
+                    bits = writer.written_bits();
+                }
+
+                // Every repetition rewinds the same reader rather than copying the input again
+                auto input = std::istringstream(std::move(expected).str());
+                auto reader = BitReader(input);
+                uint64_t checksum = 0;
+                auto read = measure(warmup, repetitions, values.size(), [&]() {
+                    reader.rewind();
+                    for (size_t i = 0; i < values.size(); ++i)
+                        checksum += read_value(reader);
+                });
+
+                // Check that the code round trips, which also keeps the reads from being optimized away
+                if (checksum != (warmup + repetitions) * std::accumulate(values.begin(), values.end(), uint64_t(0))) {
+                    std::cerr << "Values read with " << name << " do not match the values written" << std::endl;
+                    return false;
+                }
+
+                double bits_per_value = double(bits) / values.size();
+                print_row(name, distribution.name, "write", write, bits_per_value);
+                print_row(name, distribution.name, "read", read, bits_per_value);
+                return true;
+            });
+            if (!ok)
+                return EXIT_FAILURE;
+        }
+    } catch (const std::runtime_error& err) {
+        std::cerr << "Exception occurred: " << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include "decode/bitreader.hpp"
 #include "utility.hpp"
 #include "exceptions.hpp"
+#include "instrumentation.hpp"
 #include <istream>
 #include <limits>
 #include <climits>
@@ -10,7 +11,7 @@
 #include <bitset>
 
 BitReader::BitReader(std::istream& input):
-    input(input), offset(0), buffer_bytes_left(0) {
+    input(input), offset(0), buffer_bytes_left(0), buffer_start(0), input_start(input.tellg()) {
     for (size_t i = 0; i < buffer_size; ++i) {
         this->buffer[i] = 0;
     }
@@ -22,6 +23,35 @@ auto BitReader::at_end() const -> bool {
     return this->input.eof();
 }
 
+auto BitReader::bit_position() const -> uint64_t {
+    return this->buffer_start * bit_size_of<uint8_t>() + this->offset;
+}
+
+auto BitReader::align() -> void {
+    auto bits = this->offset % bit_size_of<uint8_t>();
+    if (bits != 0)
+        this->discard(bit_size_of<uint8_t>() - bits);
+}
+
+auto BitReader::rewind() -> void {
+    if (this->input_start < 0)
+        throw IoException("Input cannot be rewound");
+
+    this->input.clear();
+    this->input.seekg(this->input_start);
+    if (!this->input)
+        throw IoException("Failed to rewind input");
+
+    this->offset = 0;
+    this->buffer_bytes_left = 0;
+    this->buffer_start = 0;
+    this->refill_buffer();
+}
+
+auto BitReader::on_progress(std::function<void()> callback) -> void {
+    this->progress_callback = std::move(callback);
+}
+
 auto BitReader::peek_bit() -> std::optional<uint8_t> {
     if (this->buffer_bits_left() == 0) {
         return std::nullopt;
@@ -43,22 +73,26 @@ auto BitReader::read_bit() -> uint8_t {
 
 auto BitReader::read_bits(size_t n) -> uint64_t {
     assert(n <= bit_size_of<uint64_t>());
+    if (n == 0)
+        return 0;
 
     uint64_t result = 0;
     while (true) {
         auto buf = this->peek_buffer();
-        uint64_t value = bit_reverse(buf.value) >> (bit_size_of<uint64_t>() - buf.len);
-        if (buf.len == 0) {
+        if (buf.len == 0)
             throw EncodingException("Unexpected EOF");
-        } else if (n <= buf.len) {
+
+        uint64_t value = bit_reverse(buf.value) >> (bit_size_of<uint64_t>() - buf.len);
+        if (n <= buf.len) {
             auto x = buf.len - n;
             value >>= x;
-            result <<= n;
+            // Only the first part of a read can be all 64 bits, when there is nothing to shift yet
+            result = n < bit_size_of<uint64_t>() ? result << n : 0;
             result |= value;
             this->discard(n);
             break;
         } else {
-            result <<= buf.len;
+            result = buf.len < bit_size_of<uint64_t>() ? result << buf.len : 0;
             result |= value;
             n -= buf.len;
             this->discard(buf.len);
@@ -70,6 +104,7 @@ auto BitReader::read_bits(size_t n) -> uint64_t {
 
 auto BitReader::read_unary(uint8_t bit) -> uint64_t {
     assert(bit == 0 || bit == 1);
+    JORMUNGANDR_COUNT(BITREADER_UNARY_SCANS, 1);
 
     uint64_t result = 0;
 
@@ -100,48 +135,83 @@ auto BitReader::read_unary(uint8_t bit) -> uint64_t {
 
 auto BitReader::read_unary_with_terminator(uint8_t bit) -> uint64_t {
     uint64_t val = this->read_unary(bit);
-    assert(this->read_bit() == !bit);
+    // The terminator must be consumed even when assertions are disabled
+    [[maybe_unused]] auto terminator = this->read_bit();
+    assert(terminator == !bit);
     return val;
 }
 
 auto BitReader::read_gamma() -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_GAMMA_CODES, 1);
     uint64_t length = this->read_unary(0) + 1;
     // Correct for the fact that gamma coding does not support 0
     return this->read_bits(length) - 1;
 }
 
 auto BitReader::read_delta() -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_DELTA_CODES, 1);
     uint64_t n = this->read_gamma();
-    uint64_t value = 1 << n | this->read_bits(n);
+    uint64_t value = power_of_two(n) | this->read_bits(n);
     // Correct for the fact that delta coding does not support 0
     return value - 1;
 }
 
 auto BitReader::read_minimal_binary(uint64_t z) -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_MINIMAL_BINARY_CODES, 1);
     uint64_t s = std::bit_width(z);
-    uint64_t m = (1 << s) - z;
+    uint64_t m = power_of_two(s) - z;
     uint64_t x = this->read_bits(s - 1);
     return x < m ? x : (x << 1) + this->read_bit() - m;
 }
 
 auto BitReader::read_zeta(uint64_t k) -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_ZETA_CODES, 1);
     uint64_t h = this->read_unary_with_terminator(0);
     // read minimal binary of [0, 2^(hk + k) - 2^hk - 1]
-    uint64_t z = (1 << (h * k + k)) - (1 << (h * k));
-    uint64_t v = this->read_minimal_binary(z) + (1 << (h * k));
+    uint64_t z = power_of_two(h * k + k) - power_of_two(h * k);
+    uint64_t v = this->read_minimal_binary(z) + power_of_two(h * k);
     // Correct for the fact that zeta coding does not support 0
     return v - 1;
 }
 
 auto BitReader::read_golomb(uint64_t b) -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_GOLOMB_CODES, 1);
     if (b == 0)
         return 0;
 
+    if (std::has_single_bit(b)) {
+        uint64_t shift = std::countr_zero(b);
+        uint64_t q = this->read_unary_with_terminator(0) << shift;
+        return shift == 0 ? q : q | this->read_bits(shift);
+    }
+
     uint64_t q = this->read_unary_with_terminator(0) * b;
     return q + this->read_minimal_binary(b);
 }
 
+auto BitReader::read_nibble() -> uint64_t {
+    // The buffer holds the bits in reverse order, so groups are looked up reversed
+    constexpr const uint8_t reversed[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+    JORMUNGANDR_COUNT(BITREADER_NIBBLE_CODES, 1);
+
+    uint64_t value = 0;
+    uint64_t group;
+    do {
+        auto buf = this->peek_buffer();
+        if (buf.len >= 4) {
+            group = reversed[buf.value & 0b1111];
+            this->discard(4);
+        } else {
+            group = this->read_bits(4);
+        }
+        value = value << 3 | (group & 0b111);
+    } while (!(group & 0b1000));
+
+    return value;
+}
+
 auto BitReader::read_pred_size(uint64_t size) -> uint64_t {
+    JORMUNGANDR_COUNT(BITREADER_PRED_SIZE_CODES, 1);
     if(size == 0)
         return 0;
 
@@ -161,6 +231,8 @@ auto BitReader::discard(size_t amt) -> void {
 }
 
 auto BitReader::refill_buffer() -> void {
+    JORMUNGANDR_TIME(BITREADER_REFILL);
+    this->buffer_start += this->buffer_bytes_left;
     this->input.read(
         reinterpret_cast<char*>(this->buffer),
         buffer_size * sizeof(uint64_t)
@@ -168,6 +240,8 @@ auto BitReader::refill_buffer() -> void {
 
     this->offset = 0;
     size_t bytes_read = this->input.gcount();
+    JORMUNGANDR_COUNT(BITREADER_REFILLS, 1);
+    JORMUNGANDR_COUNT(BITREADER_BYTES_READ, bytes_read);
     size_t valid_elements = bytes_read / sizeof(uint64_t);
     size_t valid_last_bytes = bytes_read % sizeof(uint64_t);
 
@@ -182,6 +256,8 @@ auto BitReader::refill_buffer() -> void {
     }
 
     this->buffer_bytes_left = bytes_read;
+    if (this->progress_callback)
+        this->progress_callback();
 }
 
 auto BitReader::buffer_element_offset() -> size_t {
@@ -0,0 +1,18 @@
+#include "decode/chunks.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+
+ChunkIndexDecoder::ChunkIndexDecoder(std::istream& input) : input(input) {}
+
+auto ChunkIndexDecoder::decode() -> std::vector<ChunkEntry> {
+    auto chunks = std::vector<ChunkEntry>();
+    uint64_t values[2];
+    while (this->input.read(reinterpret_cast<char*>(values), sizeof values))
+        chunks.push_back({byte_swap(values[0]), byte_swap(values[1])});
+
+    if (this->input.gcount() != 0)
+        throw EncodingException("Truncated chunk index");
+
+    return chunks;
+}
@@ -5,9 +5,11 @@
 #include <cassert>
 #include <cstring>
 #include <bitset>
+#include <algorithm>
 
 BitWriter::BitWriter(std::ostream& output):
-    output(output), current_output(0), output_offset(0) {
+    output(output), current_output(0), output_offset(0), bits_written(0), progress_interval_bits(0),
+    next_progress_bits(0) {
 }
 
 BitWriter::~BitWriter() {
@@ -15,6 +17,7 @@ BitWriter::~BitWriter() {
 }
 
 auto BitWriter::write_bit(uint8_t bit) -> void {
+    ++this->bits_written;
     this->current_output |= uint64_t(bit) << (bit_size_of<uint64_t>() - 1 - this->output_offset);
     if(++this->output_offset == bit_size_of<uint64_t>())
         this->flush_buffer();
@@ -23,10 +26,14 @@ auto BitWriter::write_bit(uint8_t bit) -> void {
 auto BitWriter::write_bits(uint64_t value, uint64_t n, std::endian endian) -> void {
     assert(n <= bit_size_of<uint64_t>());
     assert(std::bit_width(value) <= n);
+    if(n == 0)
+        return;
 
     if(endian == std::endian::little)
         value = bit_reverse(value) >> (bit_size_of<uint64_t>() - n);
 
+    this->bits_written += n;
+
     size_t bits_left_first = bit_size_of<uint64_t>() - this->output_offset;
     if(bits_left_first >= n) {
         this->current_output |= value << (bits_left_first - n);
@@ -46,7 +53,7 @@ auto BitWriter::write_bits(uint64_t value, uint64_t n, std::endian endian) -> vo
 auto BitWriter::write_unary(uint64_t value, uint8_t bit) -> void {
     while(value > 0) {
         size_t num_bits = value > bit_size_of<uint64_t>() ? bit_size_of<uint64_t>() : value;
-        this->write_bits(bit ? (1ull << num_bits) - 1 : 0, num_bits);
+        this->write_bits(bit ? ~uint64_t(0) >> (bit_size_of<uint64_t>() - num_bits) : 0, num_bits);
         value -= num_bits;
     }
 }
@@ -67,12 +74,12 @@ auto BitWriter::write_delta(uint64_t value) -> void {
     ++value; // Correct for not supporting 0
     uint64_t n = std::bit_width(value) - 1;
     this->write_gamma(n);
-    this->write_bits(value & ~(1 << n), n);
+    this->write_bits(value & ~power_of_two(n), n);
 }
 
 auto BitWriter::write_minimal_binary(uint64_t value, uint64_t z) -> void {
     uint64_t s = std::bit_width(z);
-    uint64_t m = 1 << s;
+    uint64_t m = power_of_two(s);
     if (value < m - z) {
         this->write_bits(value, s - 1);
     } else {
@@ -84,24 +91,52 @@ auto BitWriter::write_zeta(uint64_t value, uint64_t k) -> void {
     ++value; // Correct for not supporting 0
     uint64_t h = (std::bit_width(value) - 1) / k;
     this->write_unary_with_terminator(h, 0);
-    uint64_t z = (1 << (h * k + k)) - (1 << (h * k));
-    this->write_minimal_binary(value - (1 << (h * k)), z);
+    uint64_t z = power_of_two(h * k + k) - power_of_two(h * k);
+    this->write_minimal_binary(value - power_of_two(h * k), z);
 }
 
 auto BitWriter::write_golomb(uint64_t value, uint64_t b) -> void {
     if (b == 0)
         return;
 
+    // Rice codes write the remainder as plain bits
+    if (std::has_single_bit(b)) {
+        uint64_t shift = std::countr_zero(b);
+        this->write_unary_with_terminator(value >> shift, 0);
+        if (shift > 0)
+            this->write_bits(value & (b - 1), shift);
+        return;
+    }
+
     this->write_unary_with_terminator(value / b, 0);
     this->write_minimal_binary(value % b, b);
 }
 
+auto BitWriter::write_nibble(uint64_t value) -> void {
+    // Groups of 3 bits, most significant first, each preceded by a bit which is set for the last group
+    uint64_t groups = value == 0 ? 1 : (std::bit_width(value) + 2) / 3;
+    for (uint64_t i = groups; i-- > 0;)
+        this->write_bits((i == 0 ? 0b1000 : 0) | ((value >> (3 * i)) & 0b111), 4);
+}
+
 auto BitWriter::write_pred_size(uint64_t value, uint64_t size) -> void {
     auto bit_width = std::bit_width(value);
     this->write_bits(bit_width, size);
     this->write_bits(value, bit_width);
 }
 
+auto BitWriter::on_progress(std::function<void()> callback, uint64_t interval_bytes) -> void {
+    this->progress_callback = std::move(callback);
+    this->progress_interval_bits = std::max<uint64_t>(interval_bytes, 1) * bit_size_of<uint8_t>();
+    this->next_progress_bits = this->bits_written + this->progress_interval_bits;
+}
+
+auto BitWriter::align() -> void {
+    auto bits = this->bits_written % bit_size_of<uint8_t>();
+    if (bits != 0)
+        this->write_bits(0, bit_size_of<uint8_t>() - bits);
+}
+
 auto BitWriter::flush() -> void {
     this->flush_buffer();
     this->output.flush();
@@ -113,4 +148,9 @@ auto BitWriter::flush_buffer() -> void {
     this->output.write(((const char*)&output), num_bytes);
     this->current_output = 0;
     this->output_offset = 0;
+
+    if (this->progress_callback && this->bits_written >= this->next_progress_bits) {
+        this->next_progress_bits = this->bits_written + this->progress_interval_bits;
+        this->progress_callback();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "encoding.hpp"
+#include "encode/chunks.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+
+ChunkIndexEncoder::ChunkIndexEncoder(std::ostream& output) : output(output) {}
+
+auto ChunkIndexEncoder::encode(const std::vector<ChunkEntry>& chunks) -> void {
+    for (const auto& chunk : chunks) {
+        for (auto value : {chunk.first_node, chunk.offset}) {
+            uint64_t big_endian = byte_swap(value);
+            this->output.write(reinterpret_cast<const char*>(&big_endian), sizeof big_endian);
+        }
+    }
+}
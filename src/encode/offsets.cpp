@@ -0,0 +1,19 @@
+#include "encode/offsets.hpp"
+#include "encode/bitwriter.hpp"
+#include "exceptions.hpp"
+
+#include <iostream>
+
+OffsetsEncoder::OffsetsEncoder(std::ostream& output) : output(output) {}
+
+auto OffsetsEncoder::encode(const std::vector<uint64_t>& offsets) -> void {
+    auto writer = BitWriter(this->output);
+    uint64_t prev = 0;
+    for (auto offset : offsets) {
+        if (offset < prev)
+            throw EncodingException("Offsets are not increasing");
+        writer.write_gamma(offset - prev);
+        prev = offset;
+    }
+    writer.flush();
+}
@@ -0,0 +1,130 @@
+#include "encode/statistics.hpp"
+
+#include <cmath>
+#include <string>
+
+namespace {
+    auto trimmed_histogram(const auto& histogram) -> std::vector<uint64_t> {
+        auto result = std::vector<uint64_t>(histogram.begin(), histogram.end());
+        while (!result.empty() && result.back() == 0)
+            result.pop_back();
+        return result;
+    }
+
+    auto average_gap(const EncodingStatistics::GapHistogram& histogram) -> double {
+        // Use the midpoint of every bucket, as the exact gaps are not retained
+        double total = 0;
+        uint64_t count = 0;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            total += histogram[i] * ((1ull << i) * 1.5 - 1);
+            count += histogram[i];
+        }
+        return count == 0 ? 0 : total / count;
+    }
+
+    auto read_histogram(const PropertyMap& properties, const std::string& key, EncodingStatistics::GapHistogram& histogram) {
+        if (!properties.maybe_as<std::string>(key))
+            return;
+        auto values = properties.as_list<uint64_t>(key);
+        for (size_t i = 0; i < values.size() && i < histogram.size(); ++i)
+            histogram[i] = values[i];
+    }
+}
+
+auto EncodingStatistics::total_bits() const -> uint64_t {
+    return this->bits_for_outdegrees + this->bits_for_references + this->bits_for_block_counts +
+        this->bits_for_blocks + this->bits_for_intervals + this->bits_for_residuals;
+}
+
+auto EncodingStatistics::to_properties(PropertyMap& properties) const -> void {
+    auto bits = this->total_bits();
+
+    properties.set("bitsforoutdegrees", this->bits_for_outdegrees);
+    properties.set("bitsforreferences", this->bits_for_references);
+    properties.set("bitsforblockcounts", this->bits_for_block_counts);
+    properties.set("bitsforblocks", this->bits_for_blocks);
+    properties.set("bitsforintervals", this->bits_for_intervals);
+    properties.set("bitsforresiduals", this->bits_for_residuals);
+    properties.set("bitsperlink", this->arcs == 0 ? 0.0 : double(bits) / this->arcs);
+    properties.set("bitspernode", this->nodes == 0 ? 0.0 : double(bits) / this->nodes);
+
+    properties.set("copiedarcs", this->copied_arcs);
+    properties.set("intervalisedarcs", this->interval_arcs);
+    properties.set("residualarcs", this->residual_arcs);
+
+    properties.set("avgref", this->nodes == 0 ? 0.0 : double(this->total_reference_distance) / this->nodes);
+    properties.set("avgdist", this->references == 0 ? 0.0 : double(this->total_reference_distance) / this->references);
+    properties.set_list("refchainstats", this->reference_chain_lengths);
+
+    properties.set("successoravggap", average_gap(this->successor_gaps));
+    properties.set("residualavggap", average_gap(this->residual_gaps));
+    properties.set_list("successorexpstats", trimmed_histogram(this->successor_gaps));
+    properties.set_list("residualexpstats", trimmed_histogram(this->residual_gaps));
+}
+
+auto EncodingStatistics::operator+=(const EncodingStatistics& other) -> EncodingStatistics& {
+    this->nodes += other.nodes;
+    this->arcs += other.arcs;
+
+    this->bits_for_outdegrees += other.bits_for_outdegrees;
+    this->bits_for_references += other.bits_for_references;
+    this->bits_for_block_counts += other.bits_for_block_counts;
+    this->bits_for_blocks += other.bits_for_blocks;
+    this->bits_for_intervals += other.bits_for_intervals;
+    this->bits_for_residuals += other.bits_for_residuals;
+
+    this->copied_arcs += other.copied_arcs;
+    this->interval_arcs += other.interval_arcs;
+    this->residual_arcs += other.residual_arcs;
+
+    this->copy_blocks += other.copy_blocks;
+    this->copy_block_sum += other.copy_block_sum;
+    this->residual_gap_sum += other.residual_gap_sum;
+
+    this->references += other.references;
+    this->total_reference_distance += other.total_reference_distance;
+    if (other.reference_chain_lengths.size() > this->reference_chain_lengths.size())
+        this->reference_chain_lengths.resize(other.reference_chain_lengths.size(), 0);
+    for (size_t i = 0; i < other.reference_chain_lengths.size(); ++i)
+        this->reference_chain_lengths[i] += other.reference_chain_lengths[i];
+
+    for (size_t i = 0; i < this->successor_gaps.size(); ++i) {
+        this->successor_gaps[i] += other.successor_gaps[i];
+        this->residual_gaps[i] += other.residual_gaps[i];
+    }
+
+    return *this;
+}
+
+auto EncodingStatistics::from_properties(const PropertyMap& properties) -> EncodingStatistics {
+    auto stats = EncodingStatistics();
+    auto get = [&](const std::string& key) {
+        return properties.maybe_as<uint64_t>(key).value_or(0);
+    };
+
+    stats.nodes = get("nodes");
+    stats.arcs = get("arcs");
+
+    stats.bits_for_outdegrees = get("bitsforoutdegrees");
+    stats.bits_for_references = get("bitsforreferences");
+    stats.bits_for_block_counts = get("bitsforblockcounts");
+    stats.bits_for_blocks = get("bitsforblocks");
+    stats.bits_for_intervals = get("bitsforintervals");
+    stats.bits_for_residuals = get("bitsforresiduals");
+
+    stats.copied_arcs = get("copiedarcs");
+    stats.interval_arcs = get("intervalisedarcs");
+    stats.residual_arcs = get("residualarcs");
+
+    auto avgref = properties.maybe_as<double>("avgref").value_or(0);
+    auto avgdist = properties.maybe_as<double>("avgdist").value_or(0);
+    stats.total_reference_distance = std::llround(avgref * stats.nodes);
+    stats.references = avgdist == 0 ? 0 : std::llround(stats.total_reference_distance / avgdist);
+    if (properties.maybe_as<std::string>("refchainstats"))
+        stats.reference_chain_lengths = properties.as_list<uint64_t>("refchainstats");
+
+    read_histogram(properties, "successorexpstats", stats.successor_gaps);
+    read_histogram(properties, "residualexpstats", stats.residual_gaps);
+
+    return stats;
+}
@@ -1,5 +1,52 @@
 #include "encoding.hpp"
 #include <string_view>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+auto encoding_from_string(std::string_view name) -> Encoding {
+    if (name == "DELTA") {
+        return Encoding::DELTA;
+    } else if (name == "GAMMA") {
+        return Encoding::GAMMA;
+    } else if (name == "UNARY") {
+        return Encoding::UNARY;
+    } else if (name == "ZETA") {
+        return Encoding::ZETA;
+    } else if (name == "PRED_SIZE") {
+        return Encoding::PRED_SIZE;
+    } else if (name == "GOLOMB") {
+        return Encoding::GOLOMB;
+    } else if (name == "NIBBLE") {
+        return Encoding::NIBBLE;
+    } else {
+        throw PropertyException("Invalid encoding '", name, "'");
+    }
+}
+
+auto encoding_to_string(Encoding encoding) -> std::string {
+    switch (encoding) {
+        case Encoding::DELTA: return "DELTA";
+        case Encoding::GAMMA: return "GAMMA";
+        case Encoding::UNARY: return "UNARY";
+        case Encoding::ZETA: return "ZETA";
+        case Encoding::PRED_SIZE: return "PRED_SIZE";
+        case Encoding::GOLOMB: return "GOLOMB";
+        case Encoding::NIBBLE: return "NIBBLE";
+    }
+    throw PropertyException("Invalid encoding");
+}
+
+auto golomb_parameter(uint64_t sum, uint64_t count) -> uint32_t {
+    if (count == 0 || sum == 0)
+        return 1;
+
+    // For a geometric distribution with success probability p, the optimal parameter is the
+    // smallest b with (1 - p)^b <= 1 / (2 - p).
+    double p = double(count) / (double(sum) + double(count));
+    double b = std::ceil(std::log(2 - p) / -std::log1p(-p));
+    return uint32_t(std::clamp(b, 1.0, double(std::numeric_limits<uint32_t>::max())));
+}
 
 auto EncodingConfig::from_properties(const PropertyMap& properties) -> EncodingConfig {
     EncodingConfig config;
@@ -23,25 +70,32 @@ auto EncodingConfig::from_properties(const PropertyMap& properties) -> EncodingC
         config.pred_size = pred_size.value();
     }
 
+    if (auto golomb_b = properties.maybe_as<uint32_t>("outdegreegolomb")) {
+        config.outdegree_golomb_b = golomb_b.value();
+    }
+
+    if (auto golomb_b = properties.maybe_as<uint32_t>("blockgolomb")) {
+        config.copy_block_golomb_b = golomb_b.value();
+    }
+
+    if (auto golomb_b = properties.maybe_as<uint32_t>("residualgolomb")) {
+        config.residual_golomb_b = golomb_b.value();
+    }
+
+    if (auto chunk_nodes = properties.maybe_as<uint32_t>("chunknodes")) {
+        config.chunk_nodes = chunk_nodes.value();
+    }
+
+    if (auto chunk_bytes = properties.maybe_as<uint32_t>("chunkbytes")) {
+        config.chunk_bytes = chunk_bytes.value();
+    }
+
     auto parse_encoding = [](std::string_view flag, std::string_view compression_type) -> std::optional<Encoding> {
         if (!flag.starts_with(compression_type)) {
             return std::nullopt;
         }
 
-        auto encoding_str = flag.substr(compression_type.size());
-        if (encoding_str == "DELTA") {
-            return Encoding::DELTA;
-        } else if (encoding_str == "GAMMA") {
-            return Encoding::GAMMA;
-        } else if (encoding_str == "UNARY") {
-            return Encoding::UNARY;
-        } else if (encoding_str == "ZETA") {
-            return Encoding::ZETA;
-        } else if (encoding_str == "PRED_SIZE") {
-            return Encoding::PRED_SIZE;
-        } else {
-            throw PropertyException("Invalid encoding '", encoding_str, "'");
-        }
+        return encoding_from_string(flag.substr(compression_type.size()));
     };
 
     auto compression_flags = properties.as_list<std::string>("compressionflags", "|");
@@ -64,6 +118,12 @@ auto EncodingConfig::from_properties(const PropertyMap& properties) -> EncodingC
         }
     }
 
+    // The block counts and references have no Golomb parameter
+    for (auto encoding : {config.block_count_encoding, config.reference_encoding}) {
+        if (encoding == Encoding::GOLOMB)
+            throw PropertyException("Golomb coding is only supported for outdegrees, copy blocks and residuals");
+    }
+
     return config;
 }
 
@@ -73,17 +133,22 @@ auto EncodingConfig::to_properties(PropertyMap& properties) -> void {
     properties.set("zetak", this->zeta_k);
     properties.set("windowsize", this->window_size);
     properties.set("maxrefcount", this->max_ref_count);
-    properties.set("pred_size", this->pred_size);
-
-    auto encoding_to_string = [](Encoding& encoding) {
-        switch (encoding) {
-            case Encoding::DELTA: return std::string("DELTA");
-            case Encoding::GAMMA: return std::string("GAMMA");
-            case Encoding::UNARY: return std::string("UNARY");
-            case Encoding::ZETA: return std::string("ZETA");
-            case Encoding::PRED_SIZE: return std::string("PRED_SIZE");
-        }
-    };
+    properties.set("minintervallength", this->min_interval_size);
+    properties.set("predsize", this->pred_size);
+
+    // Only written when used, as the Java implementation does not support Golomb coded graphs
+    if (this->outdegree_encoding == Encoding::GOLOMB)
+        properties.set("outdegreegolomb", this->outdegree_golomb_b);
+    if (this->copy_block_encoding == Encoding::GOLOMB)
+        properties.set("blockgolomb", this->copy_block_golomb_b);
+    if (this->residual_encoding == Encoding::GOLOMB)
+        properties.set("residualgolomb", this->residual_golomb_b);
+
+    // Only written for chunked graphs, which the Java implementation cannot read
+    if (this->chunk_nodes > 0)
+        properties.set("chunknodes", this->chunk_nodes);
+    if (this->chunk_bytes > 0)
+        properties.set("chunkbytes", this->chunk_bytes);
 
     auto flags = std::vector<std::string>();
     if (this->copy_block_encoding != default_encoding.copy_block_encoding)
@@ -0,0 +1,45 @@
+#include "graph/bitmap.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+RankSelectBitmap::RankSelectBitmap(size_t size):
+    words(size / 64 + 1, 0), bits(size) {
+    this->build_index();
+}
+
+auto RankSelectBitmap::build_index() -> void {
+    size_t blocks = (this->words.size() + block_words - 1) / block_words;
+    this->block_ranks.resize(blocks + 1);
+    uint64_t rank = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        this->block_ranks[block] = rank;
+        size_t last = std::min((block + 1) * block_words, this->words.size());
+        for (size_t w = block * block_words; w < last; ++w)
+            rank += std::popcount(this->words[w]);
+    }
+    this->block_ranks[blocks] = rank;
+}
+
+auto RankSelectBitmap::select(uint64_t rank) const -> size_t {
+    assert(rank < this->count());
+    // The last block starting with fewer ones than rank + 1
+    auto it = std::upper_bound(this->block_ranks.begin(), this->block_ranks.end(), rank);
+    size_t block = it - this->block_ranks.begin() - 1;
+    rank -= this->block_ranks[block];
+
+    size_t word = block * block_words;
+    while (true) {
+        size_t ones = std::popcount(this->words[word]);
+        if (rank < ones)
+            break;
+        rank -= ones;
+        ++word;
+    }
+
+    // Clear the lower ones of the word until the one we are after is the lowest
+    uint64_t bits = this->words[word];
+    for (; rank > 0; --rank)
+        bits &= bits - 1;
+    return word * 64 + std::countr_zero(bits);
+}
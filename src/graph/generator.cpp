@@ -0,0 +1,25 @@
+#include "graph/generator.hpp"
+
+auto generator_model_from_string(std::string_view name) -> GeneratorModel {
+    if (name == "RMAT") {
+        return GeneratorModel::RMAT;
+    } else if (name == "COPYING") {
+        return GeneratorModel::COPYING;
+    } else if (name == "ERDOS_RENYI") {
+        return GeneratorModel::ERDOS_RENYI;
+    } else if (name == "CONFIGURATION") {
+        return GeneratorModel::CONFIGURATION;
+    } else {
+        throw PropertyException("Invalid generator model '", name, "'");
+    }
+}
+
+auto generator_model_to_string(GeneratorModel model) -> std::string {
+    switch (model) {
+        case GeneratorModel::RMAT: return "RMAT";
+        case GeneratorModel::COPYING: return "COPYING";
+        case GeneratorModel::ERDOS_RENYI: return "ERDOS_RENYI";
+        case GeneratorModel::CONFIGURATION: return "CONFIGURATION";
+    }
+    throw PropertyException("Invalid generator model");
+}
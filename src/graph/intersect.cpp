@@ -0,0 +1,49 @@
+#include "graph/intersect.hpp"
+
+#include <bit>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+auto intersection_size_u32(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size) -> size_t {
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+#ifdef __SSE2__
+    // Compare blocks of four values of a against all rotations of four values of b, and advance
+    // the block(s) with the smallest last value. SSE2 only has signed comparisons, but equality
+    // does not depend on the sign.
+    while (i + 4 <= a_size && j + 4 <= b_size) {
+        auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        auto equal = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0b00111001))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0b01001110)),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0b10010011))));
+        count += std::popcount(unsigned(_mm_movemask_ps(_mm_castsi128_ps(equal))));
+
+        uint32_t a_last = a[i + 3];
+        uint32_t b_last = b[j + 3];
+        if (a_last <= b_last)
+            i += 4;
+        if (b_last <= a_last)
+            j += 4;
+    }
+#endif
+
+    while (i < a_size && j < b_size) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,101 @@
+#include "instrumentation.hpp"
+
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+    // The counts of the threads which have exited, reported when the process exits
+    class Totals {
+        private:
+            std::mutex mutex;
+            uint64_t counts[size_t(Counter::COUNT)] = {};
+            uint64_t timer_ns[size_t(Timer::COUNT)] = {};
+            bool used = false;
+
+        public:
+            auto add(const ThreadCounters& counters) -> void {
+                auto lock = std::scoped_lock(this->mutex);
+                for (size_t i = 0; i < size_t(Counter::COUNT); ++i)
+                    this->counts[i] += counters.counts[i];
+                for (size_t i = 0; i < size_t(Timer::COUNT); ++i)
+                    this->timer_ns[i] += counters.timer_ns[i];
+                this->used = true;
+            }
+
+            ~Totals() {
+                if (!this->used)
+                    return;
+
+                auto file = std::ofstream();
+                if (auto filename = std::getenv("JORMUNGANDR_INSTRUMENTATION_REPORT"))
+                    file.open(filename);
+                std::ostream& out = file.is_open() ? file : std::cerr;
+
+                for (size_t i = 0; i < size_t(Counter::COUNT); ++i)
+                    out << counter_name(Counter(i)) << '\t' << this->counts[i] << std::endl;
+                for (size_t i = 0; i < size_t(Timer::COUNT); ++i)
+                    out << timer_name(Timer(i)) << "_ns\t" << this->timer_ns[i] << std::endl;
+            }
+    };
+
+    auto totals() -> Totals& {
+        static auto totals = Totals();
+        return totals;
+    }
+
+    // Adds the counts of its thread to the totals when the thread exits
+    struct ThreadFlush {
+        ~ThreadFlush() {
+            totals().add(thread_counters);
+        }
+    };
+}
+
+auto register_thread_counters() -> void {
+    // Constructing the totals first makes sure they outlive the counters of every thread
+    totals();
+    static thread_local auto flush = ThreadFlush();
+    (void) flush;
+    thread_counters.registered = true;
+}
+
+auto counter_name(Counter counter) -> std::string_view {
+    switch (counter) {
+        case Counter::BITREADER_REFILLS: return "bitreader.refills";
+        case Counter::BITREADER_BYTES_READ: return "bitreader.bytes_read";
+        case Counter::BITREADER_UNARY_SCANS: return "bitreader.unary_scans";
+        case Counter::BITREADER_GAMMA_CODES: return "bitreader.gamma_codes";
+        case Counter::BITREADER_DELTA_CODES: return "bitreader.delta_codes";
+        case Counter::BITREADER_ZETA_CODES: return "bitreader.zeta_codes";
+        case Counter::BITREADER_GOLOMB_CODES: return "bitreader.golomb_codes";
+        case Counter::BITREADER_NIBBLE_CODES: return "bitreader.nibble_codes";
+        case Counter::BITREADER_PRED_SIZE_CODES: return "bitreader.pred_size_codes";
+        case Counter::BITREADER_MINIMAL_BINARY_CODES: return "bitreader.minimal_binary_codes";
+        case Counter::DECODER_NODES: return "decoder.nodes";
+        case Counter::DECODER_SKIPPED_NODES: return "decoder.skipped_nodes";
+        case Counter::DECODER_COPIED_ARCS: return "decoder.copied_arcs";
+        case Counter::DECODER_INTERVAL_ARCS: return "decoder.interval_arcs";
+        case Counter::DECODER_RESIDUAL_ARCS: return "decoder.residual_arcs";
+        case Counter::DECODER_MERGES: return "decoder.merges";
+        case Counter::DECODER_MERGED_ARCS: return "decoder.merged_arcs";
+        case Counter::ENCODER_NODES: return "encoder.nodes";
+        case Counter::ENCODER_WINDOW_CANDIDATES: return "encoder.window_candidates";
+        case Counter::ENCODER_SKETCH_COMPARISONS: return "encoder.sketch_comparisons";
+        case Counter::ENCODER_INTERSECTIONS: return "encoder.intersections";
+        case Counter::ENCODER_INTERSECTED_ARCS: return "encoder.intersected_arcs";
+        case Counter::COUNT: break;
+    }
+    return "unknown";
+}
+
+auto timer_name(Timer timer) -> std::string_view {
+    switch (timer) {
+        case Timer::BITREADER_REFILL: return "bitreader.refill";
+        case Timer::DECODER_MERGE: return "decoder.merge";
+        case Timer::ENCODER_REFERENCE_SEARCH: return "encoder.reference_search";
+        case Timer::COUNT: break;
+    }
+    return "unknown";
+}
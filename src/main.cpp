@@ -5,6 +5,8 @@
 #include <bitset>
 #include <string_view>
 #include <cstring>
+#include <optional>
+#include <limits>
 
 #include "decode/property.hpp"
 #include "decode/tsv.hpp"
@@ -15,43 +17,435 @@
 #include "encode/webgraph.hpp"
 #include "encode/tsv.hpp"
 #include "encode/binary.hpp"
+#include "encode/tuner.hpp"
+#include "encode/permutation.hpp"
+#include "encode/append.hpp"
+#include "encode/sharded.hpp"
+#include "decode/sharded.hpp"
+#include "decode/eliasfano.hpp"
+#include "encode/eliasfano.hpp"
+#include "streamvbyte.hpp"
+#include "decode/streamvbyte.hpp"
+#include "decode/view.hpp"
+#include "encode/streamvbyte.hpp"
+#include "graph/reorder.hpp"
+#include "graph/subgraph.hpp"
+#include "graph/transpose.hpp"
+#include "graph/merge.hpp"
+#include "parallel.hpp"
+#include "progress.hpp"
 
 #include "bitbuffer.hpp"
 
-using node_type = uint32_t;
-
 enum class EncodingType {
     TSV,
     BINARY,
-    WEBGRAPH
+    WEBGRAPH,
+    EF,
+    STREAMVBYTE
 };
 
-auto find_property_file(const std::string& filename) {
+struct Options {
+    const char* input_file = NULL;
+    const char* output_file = NULL;
+    EncodingType input_encoding = EncodingType::TSV;
+    EncodingType output_encoding = EncodingType::WEBGRAPH;
+    std::optional<TuneObjective> tune_objective;
+    std::optional<ReorderStrategy> reorder_strategy;
+    size_t threads = default_thread_count();
+    size_t shards = 0;
+    bool transpose_graph = false;
+    size_t transpose_batch = 0;
+    bool symmetrize = false;
+    bool append = false;
+    const char* merge_file = NULL;
+    const char* subgraph_file = NULL;
+    // 32 or 64, or 0 to pick from the number of nodes of the input
+    size_t node_bits = 0;
+    bool progress = false;
+};
+
+auto replace_extension(const std::string& filename, const std::string& extension) {
     auto it = filename.find_last_of(".");
     if(it == std::string::npos)
-        return filename + ".properties";
-    return filename.substr(0, it) + ".properties";
+        return filename + extension;
+    return filename.substr(0, it) + extension;
+}
+
+auto find_property_file(const std::string& filename) {
+    return replace_extension(filename, ".properties");
+}
+
+auto open_property_file(const std::string& graph_filename) {
+    auto prop_filename = find_property_file(graph_filename);
+    auto prop_input = std::ifstream(prop_filename);
+    if(!prop_input)
+        throw PropertyException("Failed to find property file ", prop_filename);
+    return prop_input;
+}
+
+auto write_property_file(const std::string& graph_filename, const PropertyMap& props) {
+    auto prop_output_filename = find_property_file(graph_filename);
+    auto prop_output = std::ofstream(prop_output_filename);
+    if(!prop_output)
+        throw PropertyException("Failed to create property file ", prop_output_filename);
+    PropertyEncoder(prop_output).encode(props);
+}
+
+auto is_sharded(const std::string& graph_filename) {
+    auto prop_input = std::ifstream(find_property_file(graph_filename));
+    return prop_input && PropertyParser(prop_input).decode().maybe_as<size_t>("shards").has_value();
+}
+
+// Reports on stderr every few seconds, if enabled by --progress
+auto make_progress(const Options& options, std::string label) -> std::optional<ProgressReporter> {
+    if(!options.progress)
+        return std::nullopt;
+    return ProgressReporter(print_progress(std::move(label)), std::chrono::seconds(5));
+}
+
+template <std::unsigned_integral T, NodeStream<T> S>
+auto encode_stream(S& stream, const Options& options) -> void {
+    auto output = std::ofstream(options.output_file, std::ios::binary);
+    if(!output)
+        throw IoException("Failed to open output file ", options.output_file);
+
+    auto encoder = WebGraphEncoder<T>(output, EncodingConfig());
+    auto progress = make_progress(options, "encode");
+    if(progress)
+        encoder.set_progress(*progress, stream.num_nodes());
+    for(const auto& node : nodes(stream))
+        encoder.push_node(node.neighbours);
+    write_property_file(options.output_file, encoder.finish());
+}
+
+// Reads whitespace separated node ids into a bitmap
+auto read_node_set(const char* filename, uint64_t num_nodes) -> RankSelectBitmap {
+    auto input = std::ifstream(filename);
+    if(!input)
+        throw IoException("Failed to open node file ", filename);
+
+    auto nodes = RankSelectBitmap(num_nodes);
+    uint64_t node;
+    while(input >> node) {
+        if(node >= num_nodes)
+            throw EncodingException("Node ", node, " out of bounds");
+        nodes.set(node);
+    }
+    if(!input.eof())
+        throw IoException("Failed to parse node file ", filename);
+
+    nodes.build_index();
+    return nodes;
 }
 
 auto print_usage(const char* prog) -> void {
     std::cerr << "Usage: " << prog << " [options] <input file> <output file>\n"
         "options:\n"
-        "--input <tsv|binary|webgraph>\n"
-        "--output <tsv|binary|webgraph>" << std::endl;
+        "--input <tsv|binary|webgraph|ef|streamvbyte>\n"
+        "--output <tsv|binary|webgraph|ef|streamvbyte>\n"
+        "--tune <size|speed>\n"
+        "--reorder <bfs|lexicographic|gray|llp>\n"
+        "--threads <int>\n"
+        "--shards <int>: write webgraph output as shards, which are read back with webgraph input\n"
+        "--transpose\n"
+        "--transpose-batch <arcs>: transpose webgraph to webgraph using bounded memory\n"
+        "--symmetrize: symmetrize webgraph to webgraph using bounded memory\n"
+        "--merge <webgraph file>: union of two webgraphs, written as webgraph\n"
+        "--subgraph <node file>: subgraph of a webgraph induced by the nodes listed in the file, written as webgraph with the nodes renumbered in order\n"
+        "--append: append the nodes of the input after the nodes of the existing webgraph output\n"
+        "--node-bits <32|64>: width of node ids, by default 64 only if the input has too many nodes for 32. "
+        "TSV and binary input is read as 32 bits unless set\n"
+        "--progress: report the progress of webgraph decoding and encoding on stderr" << std::endl;
+}
+
+// Graphs with more nodes than fit in 32 bits are read with 64-bit node ids
+auto node_bits(const Options& options) -> size_t {
+    if(options.node_bits)
+        return options.node_bits;
+
+    auto needs_64_bits = [](const std::string& graph_filename) {
+        auto prop_input = std::ifstream(find_property_file(graph_filename));
+        if(!prop_input)
+            return false;
+        auto nodes = PropertyParser(prop_input).decode().maybe_as<uint64_t>("nodes");
+        return nodes && *nodes > std::numeric_limits<uint32_t>::max();
+    };
+
+    bool wide = false;
+    if(options.input_encoding != EncodingType::TSV && options.input_encoding != EncodingType::BINARY)
+        wide = needs_64_bits(options.input_file);
+    if(options.merge_file)
+        wide = wide || needs_64_bits(options.merge_file);
+    if(options.append)
+        wide = wide || needs_64_bits(options.output_file);
+    return wide ? 64 : 32;
+}
+
+template <std::unsigned_integral T>
+auto convert(const Options& options) -> int {
+    bool sharded_input = options.input_encoding == EncodingType::WEBGRAPH && is_sharded(options.input_file);
+    auto input = std::ifstream(options.input_file, std::ios::binary);
+    if(!input && !sharded_input) {
+        std::cerr << "Failed to open input file " << options.input_file << std::endl;
+        return 1;
+    }
+
+    if(options.transpose_batch > 0 || options.symmetrize || options.merge_file || options.subgraph_file) {
+        if(options.input_encoding != EncodingType::WEBGRAPH || options.output_encoding != EncodingType::WEBGRAPH) {
+            std::cerr << "Streaming operations require webgraph input and output" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto prop_input = open_property_file(options.input_file);
+        auto decoder = WebGraphDecoder<T>(input, prop_input);
+
+        if(options.subgraph_file) {
+            auto kept = read_node_set(options.subgraph_file, decoder.num_nodes());
+            auto subgraph = SubgraphStream<T, decltype(decoder)>(decoder, kept);
+            encode_stream<T>(subgraph, options);
+            return EXIT_SUCCESS;
+        }
+
+        if(options.merge_file) {
+            auto other_input = std::ifstream(options.merge_file, std::ios::binary);
+            if(!other_input)
+                throw IoException("Failed to open input file ", options.merge_file);
+            auto other_prop_input = open_property_file(options.merge_file);
+            auto other = WebGraphDecoder<T>(other_input, other_prop_input);
+
+            auto merged = MergeStream<T, decltype(decoder), decltype(other)>(
+                decoder, other, std::max(decoder.num_nodes(), other.num_nodes()));
+            encode_stream<T>(merged, options);
+            return EXIT_SUCCESS;
+        }
+
+        size_t batch = options.transpose_batch > 0 ? options.transpose_batch : 1 << 24;
+        // The transpose reads the whole input before the first node is encoded
+        auto read_progress = make_progress(options, "transpose");
+        if(read_progress)
+            decoder.set_progress(*read_progress);
+        auto transposed = ExternalTranspose<T>(decoder, decoder.num_nodes(), batch);
+        if(read_progress)
+            read_progress->finish(decoder.num_nodes(), decoder.num_nodes(), 0, decoder.bit_position() / 8);
+        if(!options.symmetrize) {
+            encode_stream<T>(transposed, options);
+            return EXIT_SUCCESS;
+        }
+
+        // The transpose consumed the first decoder, so read the graph a second time to merge with
+        auto second_input = std::ifstream(options.input_file, std::ios::binary);
+        if(!second_input)
+            throw IoException("Failed to open input file ", options.input_file);
+        auto second_prop_input = open_property_file(options.input_file);
+        auto second = WebGraphDecoder<T>(second_input, second_prop_input);
+
+        auto symmetric = MergeStream<T, decltype(second), decltype(transposed)>(
+            second, transposed, second.num_nodes());
+        encode_stream<T>(symmetric, options);
+        return EXIT_SUCCESS;
+    }
+
+    auto graph = [&]() {
+        switch(options.input_encoding) {
+            case EncodingType::TSV:
+                return TsvDecoder<T>(input).decode();
+            case EncodingType::BINARY:
+                return BinaryDecoder<T>(input).decode();
+            case EncodingType::WEBGRAPH: {
+                auto prop_input = open_property_file(options.input_file);
+                if(sharded_input)
+                    return ShardedDecoder<T>(replace_extension(options.input_file, ""), prop_input).decode();
+                auto decoder = WebGraphDecoder<T>(input, prop_input);
+                auto progress = make_progress(options, "decode");
+                if(progress)
+                    decoder.set_progress(*progress);
+                return decoder.decode();
+            }
+            case EncodingType::EF: {
+                auto prop_input = open_property_file(options.input_file);
+                return EliasFanoDecoder<T>(input, prop_input).decode().to_graph();
+            }
+            case EncodingType::STREAMVBYTE: {
+                auto prop_input = open_property_file(options.input_file);
+                return StreamVByteDecoder<T>(input, prop_input).decode();
+            }
+        }
+    }();
+
+    input.close();
+
+    if(options.append) {
+        if(options.output_encoding != EncodingType::WEBGRAPH) {
+            std::cerr << "Appending requires webgraph output" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto prop_input = open_property_file(options.output_file);
+        auto appender = WebGraphAppender<T>(options.output_file, prop_input);
+
+        size_t existing_nodes = appender.first_node();
+        for(size_t node = 0; node < std::min<size_t>(existing_nodes, graph.num_nodes()); ++node) {
+            if(!graph.neighbours(node).empty())
+                throw EncodingException("Cannot append arcs of existing node ", node);
+        }
+
+        for(size_t node = existing_nodes; node < graph.num_nodes(); ++node)
+            appender.push_node(graph.neighbours(node));
+        write_property_file(options.output_file, appender.finish());
+        return EXIT_SUCCESS;
+    }
+
+    if(options.transpose_graph)
+        graph = transpose(graph, options.threads);
+
+    if(options.reorder_strategy) {
+        auto permutation = compute_order(graph, options.reorder_strategy.value());
+        graph = permute(graph, permutation, options.threads);
+
+        auto perm_filename = replace_extension(options.output_file, ".perm");
+        auto perm_output = std::ofstream(perm_filename, std::ios::binary);
+        if(!perm_output) {
+            std::cerr << "Failed to create permutation file " << perm_filename << std::endl;
+            return EXIT_FAILURE;
+        }
+        PermutationEncoder(perm_output, permutation).encode();
+    }
+
+    auto encoding_config = EncodingConfig();
+    if(options.output_encoding == EncodingType::WEBGRAPH && options.tune_objective) {
+        auto tune_options = TuneOptions();
+        tune_options.objective = options.tune_objective.value();
+        encoding_config = EncodingTuner(graph, tune_options).tune();
+    }
+
+    if(options.shards > 0) {
+        if(options.output_encoding != EncodingType::WEBGRAPH) {
+            std::cerr << "Sharding requires webgraph output" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto props = ShardedEncoder(replace_extension(options.output_file, ""), encoding_config, graph).encode(options.shards, options.threads);
+        write_property_file(options.output_file, props);
+        return EXIT_SUCCESS;
+    }
+
+    auto output = std::ofstream(options.output_file, std::ios::binary);
+    if(!output) {
+        std::cerr << "Failed to open output file " << options.output_file << std::endl;
+        return 1;
+    }
+
+    switch(options.output_encoding) {
+        case EncodingType::TSV:
+            TsvEncoder(output, graph).encode();
+            break;
+        case EncodingType::BINARY:
+            BinaryEncoder(output, graph).encode();
+            break;
+        case EncodingType::WEBGRAPH: {
+            auto encoder = WebGraphEncoder(output, encoding_config, graph);
+            auto progress = make_progress(options, "encode");
+            if(progress)
+                encoder.set_progress(*progress);
+            auto props = encoder.encode();
+            write_property_file(options.output_file, props);
+            break;
+        }
+        case EncodingType::EF: {
+            auto props = EliasFanoEncoder(output, graph).encode();
+            write_property_file(options.output_file, props);
+            break;
+        }
+        case EncodingType::STREAMVBYTE: {
+            auto props = StreamVByteEncoder(output, graph).encode();
+            write_property_file(options.output_file, props);
+            break;
+        }
+    }
+
+    return EXIT_SUCCESS;
 }
 
 auto main(int argc, char* argv[]) -> int {
     try {
         bool parse_input = false;
         bool parse_output = false;
-        const char* input_file = NULL;
-        const char* output_file = NULL;
-        EncodingType input_encoding = EncodingType::TSV;
-        EncodingType output_encoding = EncodingType::WEBGRAPH;
+        bool parse_tune = false;
+        bool parse_reorder = false;
+        bool parse_threads = false;
+        bool parse_transpose_batch = false;
+        bool parse_merge = false;
+        bool parse_subgraph = false;
+        bool parse_shards = false;
+        bool parse_node_bits = false;
+        auto options = Options();
 
         for(int i = 1; i < argc; ++i) {
             const char* arg = argv[i];
 
+            if(parse_tune) {
+                if(!std::strcmp(arg, "size"))
+                    options.tune_objective = TuneObjective::SIZE;
+                else if(!std::strcmp(arg, "speed"))
+                    options.tune_objective = TuneObjective::SPEED;
+                else {
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                parse_tune = false;
+                continue;
+            }
+            if(parse_reorder) {
+                if(!std::strcmp(arg, "bfs"))
+                    options.reorder_strategy = ReorderStrategy::BFS;
+                else if(!std::strcmp(arg, "lexicographic"))
+                    options.reorder_strategy = ReorderStrategy::LEXICOGRAPHIC;
+                else if(!std::strcmp(arg, "gray"))
+                    options.reorder_strategy = ReorderStrategy::GRAY;
+                else if(!std::strcmp(arg, "llp"))
+                    options.reorder_strategy = ReorderStrategy::LLP;
+                else {
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                parse_reorder = false;
+                continue;
+            }
+            if(parse_threads) {
+                options.threads = std::max<size_t>(std::stoull(arg), 1);
+                parse_threads = false;
+                continue;
+            }
+            if(parse_shards) {
+                options.shards = std::max<size_t>(std::stoull(arg), 1);
+                parse_shards = false;
+                continue;
+            }
+            if(parse_merge) {
+                options.merge_file = arg;
+                parse_merge = false;
+                continue;
+            }
+            if(parse_subgraph) {
+                options.subgraph_file = arg;
+                parse_subgraph = false;
+                continue;
+            }
+            if(parse_node_bits) {
+                options.node_bits = std::stoull(arg);
+                if(options.node_bits != 32 && options.node_bits != 64) {
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                parse_node_bits = false;
+                continue;
+            }
+            if(parse_transpose_batch) {
+                options.transpose_batch = std::max<size_t>(std::stoull(arg), 1);
+                parse_transpose_batch = false;
+                continue;
+            }
             if(parse_input || parse_output) {
                 EncodingType encoding;
                 if(!std::strcmp(arg, "tsv"))
@@ -60,11 +454,15 @@ auto main(int argc, char* argv[]) -> int {
                     encoding = EncodingType::BINARY;
                 else if(!std::strcmp(arg, "webgraph"))
                     encoding = EncodingType::WEBGRAPH;
+                else if(!std::strcmp(arg, "ef"))
+                    encoding = EncodingType::EF;
+                else if(!std::strcmp(arg, "streamvbyte"))
+                    encoding = EncodingType::STREAMVBYTE;
                 else {
                     print_usage(argv[0]);
                     return EXIT_FAILURE;
                 }
-                (parse_input ? input_encoding : output_encoding) = encoding;
+                (parse_input ? options.input_encoding : options.output_encoding) = encoding;
                 parse_output = parse_input = false;
                 continue;
             }
@@ -72,11 +470,35 @@ auto main(int argc, char* argv[]) -> int {
                 parse_input = true;
             else if(!std::strcmp(arg, "--output"))
                 parse_output = true;
+            else if(!std::strcmp(arg, "--tune"))
+                parse_tune = true;
+            else if(!std::strcmp(arg, "--reorder"))
+                parse_reorder = true;
+            else if(!std::strcmp(arg, "--threads"))
+                parse_threads = true;
+            else if(!std::strcmp(arg, "--shards"))
+                parse_shards = true;
+            else if(!std::strcmp(arg, "--transpose"))
+                options.transpose_graph = true;
+            else if(!std::strcmp(arg, "--transpose-batch"))
+                parse_transpose_batch = true;
+            else if(!std::strcmp(arg, "--symmetrize"))
+                options.symmetrize = true;
+            else if(!std::strcmp(arg, "--merge"))
+                parse_merge = true;
+            else if(!std::strcmp(arg, "--subgraph"))
+                parse_subgraph = true;
+            else if(!std::strcmp(arg, "--append"))
+                options.append = true;
+            else if(!std::strcmp(arg, "--node-bits"))
+                parse_node_bits = true;
+            else if(!std::strcmp(arg, "--progress"))
+                options.progress = true;
             else {
-                if(input_file == NULL)
-                    input_file = arg;
-                else if(output_file == NULL)
-                    output_file = arg;
+                if(options.input_file == NULL)
+                    options.input_file = arg;
+                else if(options.output_file == NULL)
+                    options.output_file = arg;
                 else {
                     print_usage(argv[0]);
                     return EXIT_FAILURE;
@@ -84,62 +506,14 @@ auto main(int argc, char* argv[]) -> int {
             }
         }
 
-        if(parse_output || parse_input || !input_file || !output_file) {
+        if(parse_output || parse_input || parse_tune || parse_reorder || parse_threads || parse_transpose_batch || parse_merge || parse_subgraph || parse_shards || parse_node_bits || !options.input_file || !options.output_file) {
             print_usage(argv[0]);
             return EXIT_FAILURE;
         }
 
-        auto input = std::ifstream(input_file, std::ios::binary);
-        if(!input) {
-            std::cerr << "Failed to open input file " << input_file << std::endl;
-            return 1;
-        }
-
-        auto graph = [&]() {
-            switch(input_encoding) {
-                case EncodingType::TSV:
-                    return TsvDecoder<node_type>(input).decode();
-                case EncodingType::BINARY:
-                    return BinaryDecoder<node_type>(input).decode();
-                case EncodingType::WEBGRAPH: {
-                    auto prop_filename = find_property_file(input_file);
-                    auto prop_input = std::ifstream(prop_filename);
-                    if(!prop_input)
-                        throw PropertyException("Failed to find property file ", prop_filename);
-                    return WebGraphDecoder<node_type>(input, prop_input).decode();
-                }
-            }
-        }();
-
-        input.close();
-
-        auto output = std::ofstream(output_file, std::ios::binary);
-        if(!output) {
-            std::cerr << "Failed to open output file " << output_file << std::endl;
-            return 1;
-        }
-
-        switch(output_encoding) {
-            case EncodingType::TSV:
-                TsvEncoder(output, graph).encode();
-                break;
-            case EncodingType::BINARY:
-                BinaryEncoder(output, graph).encode();
-                break;
-            case EncodingType::WEBGRAPH: {
-                EncodingConfig encoding_config;
-                auto props = WebGraphEncoder(output, encoding_config, graph).encode();
-
-                auto prop_output_filename = find_property_file(output_file);
-                auto prop_output = std::ofstream(prop_output_filename);
-                if(!prop_output)
-                    throw PropertyException("Failed to create property file ", prop_output_filename);
-                PropertyEncoder(prop_output).encode(props);
-                break;
-            }
-        }
-
-        return EXIT_SUCCESS;
+        if(node_bits(options) == 64)
+            return convert<uint64_t>(options);
+        return convert<uint32_t>(options);
     } catch(const std::runtime_error& err) {
         std::cerr << "Exception occurred: " << err.what() << std::endl;
         return EXIT_FAILURE;
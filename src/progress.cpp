@@ -0,0 +1,71 @@
+#include "progress.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+ProgressReporter::ProgressReporter(ProgressCallback callback, clock::duration interval):
+    callback(std::move(callback)), interval(interval), start(clock::now()), last_report(start),
+    last_nodes(0), last_bytes(0) {}
+
+auto ProgressReporter::update(uint64_t nodes, uint64_t total_nodes, uint64_t arcs, uint64_t bytes) -> void {
+    auto now = clock::now();
+    if (now - this->last_report >= this->interval)
+        this->report(now, nodes, total_nodes, arcs, bytes, false);
+}
+
+auto ProgressReporter::finish(uint64_t nodes, uint64_t total_nodes, uint64_t arcs, uint64_t bytes) -> void {
+    this->report(clock::now(), nodes, total_nodes, arcs, bytes, true);
+}
+
+auto ProgressReporter::report(clock::time_point now, uint64_t nodes, uint64_t total_nodes, uint64_t arcs,
+                              uint64_t bytes, bool finished) -> void {
+    double seconds = std::chrono::duration<double>(now - this->start).count();
+    double interval_seconds = std::max(std::chrono::duration<double>(now - this->last_report).count(), 1e-9);
+
+    auto progress = Progress{
+        .nodes = nodes,
+        .total_nodes = total_nodes,
+        .arcs = arcs,
+        .bytes = bytes,
+        .seconds = seconds,
+        .nodes_per_second = (nodes - std::min(nodes, this->last_nodes)) / interval_seconds,
+        .bytes_per_second = (bytes - std::min(bytes, this->last_bytes)) / interval_seconds,
+        .eta_seconds = std::nullopt,
+        .finished = finished
+    };
+    if (total_nodes > 0 && nodes > 0 && nodes <= total_nodes)
+        progress.eta_seconds = seconds / nodes * (total_nodes - nodes);
+
+    this->last_report = now;
+    this->last_nodes = nodes;
+    this->last_bytes = bytes;
+    this->callback(progress);
+}
+
+auto print_progress(std::string label) -> ProgressCallback {
+    return [label = std::move(label)](const Progress& progress) {
+        // Formatted first, so that the line is written at once
+        auto line = std::ostringstream();
+        line << std::fixed << std::setprecision(1) << label << ": " << progress.nodes;
+        if (progress.total_nodes > 0)
+            line << "/" << progress.total_nodes << " nodes (" << 100.0 * progress.nodes / progress.total_nodes << "%)";
+        else
+            line << " nodes";
+        if (progress.arcs > 0)
+            line << ", " << progress.arcs << " arcs";
+        line << ", " << progress.bytes / 1e6 << " MB";
+
+        if (progress.finished) {
+            line << " in " << progress.seconds << " s";
+        } else {
+            line << ", " << uint64_t(progress.nodes_per_second) << " nodes/s, "
+                 << progress.bytes_per_second / 1e6 << " MB/s";
+            if (progress.eta_seconds)
+                line << ", ETA " << uint64_t(*progress.eta_seconds) << " s";
+        }
+        line << '\n';
+        std::cerr << line.str() << std::flush;
+    };
+}
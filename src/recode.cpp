@@ -6,6 +6,7 @@
 #include <string_view>
 #include <chrono>
 #include <bitset>
+#include <limits>
 
 #include "decode/property.hpp"
 #include "decode/tsv.hpp"
@@ -17,14 +18,13 @@
 
 #include "bitbuffer.hpp"
 
-using node_type = uint32_t;
-
-auto graph_eql(const Graph<node_type>& a, const Graph<node_type>& b) {
+template <std::unsigned_integral T>
+auto graph_eql(const Graph<T>& a, const Graph<T>& b) {
     if (a.num_nodes() != b.num_nodes()) {
         return false;
     }
 
-    for (node_type i = 0; i < a.num_nodes(); ++i) {
+    for (size_t i = 0; i < a.num_nodes(); ++i) {
         auto na = a.neighbours(i);
         auto nb = b.neighbours(i);
 
@@ -36,6 +36,30 @@ auto graph_eql(const Graph<node_type>& a, const Graph<node_type>& b) {
     return true;
 }
 
+template <std::unsigned_integral T>
+auto recode(const std::string& basename) -> void {
+    std::cout << "Decoding" << std::endl;
+    auto in = std::ifstream(basename + ".graph", std::ios::binary);
+    auto props = std::ifstream(basename + ".properties", std::ios::binary);
+    auto decoder = WebGraphDecoder<T>(in, props);
+    auto original = decoder.decode();
+
+    auto encoding = EncodingConfig();
+
+    std::cout << "Re-encoding" << std::endl;
+    auto ss = std::stringstream();
+    {
+        auto encoder = WebGraphEncoder<T>(ss, encoding, original);
+        auto new_props = encoder.encode();
+    }
+
+    std::cout << "Re-decoding" << std::endl;
+    auto redecoder = WebGraphDecoder<T>(ss, original.num_nodes(), encoding);
+    auto decoded = redecoder.decode();
+
+    std::cout << "Graphs are " << (graph_eql(original, decoded) ? "" : "not ") << "equal" << std::endl;
+}
+
 auto main(int argc, char* argv[]) -> int {
     try {
         if (argc < 2) {
@@ -43,26 +67,16 @@ auto main(int argc, char* argv[]) -> int {
             return EXIT_FAILURE;
         }
 
-        std::cout << "Decoding" << std::endl;
-        auto in = std::ifstream(std::string(argv[1]) + ".graph", std::ios::binary);
-        auto props = std::ifstream(std::string(argv[1]) + ".properties", std::ios::binary);
-        auto decoder = WebGraphDecoder<node_type>(in, props);
-        auto original = decoder.decode();
-
-        auto encoding = EncodingConfig();
-
-        std::cout << "Re-encoding" << std::endl;
-        auto ss = std::stringstream();
-        {
-            auto encoder = WebGraphEncoder<node_type>(ss, encoding, original);
-            auto new_props = encoder.encode();
-        }
-
-        std::cout << "Re-decoding" << std::endl;
-        auto redecoder = WebGraphDecoder<node_type>(ss, original.num_nodes(), encoding);
-        auto decoded = redecoder.decode();
+        auto basename = std::string(argv[1]);
+        auto props = std::ifstream(basename + ".properties", std::ios::binary);
+        if (!props)
+            throw PropertyException("Failed to find property file ", basename, ".properties");
 
-        std::cout << "Graphs are " << (graph_eql(original, decoded) ? "" : "not ") << "equal" << std::endl;
+        // Only use 64-bit nodes for graphs that need them
+        if (PropertyParser(props).decode().as<uint64_t>("nodes") > std::numeric_limits<uint32_t>::max())
+            recode<uint64_t>(basename);
+        else
+            recode<uint32_t>(basename);
 
         return EXIT_SUCCESS;
     } catch(const std::runtime_error& err) {
@@ -0,0 +1,134 @@
+#include "streamvbyte.hpp"
+
+#include <array>
+
+// The shuffle kernel is compiled for SSSE3 on any x86 build and picked at runtime, so that the
+// default build does not fall back to the scalar loop
+#if defined(__x86_64__) || defined(__i386__)
+#define JORMUNGANDR_STREAMVBYTE_SSSE3
+#include <immintrin.h>
+#endif
+
+namespace {
+    auto value_length(uint32_t value) -> uint8_t {
+        return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+    }
+
+    constexpr auto group_length(uint8_t control) -> uint8_t {
+        return 4 + (control & 3) + ((control >> 2) & 3) + ((control >> 4) & 3) + (control >> 6);
+    }
+
+    constexpr auto make_lengths() {
+        auto lengths = std::array<uint8_t, 256>();
+        for (size_t control = 0; control < 256; ++control)
+            lengths[control] = group_length(control);
+        return lengths;
+    }
+
+    constexpr auto lengths = make_lengths();
+
+    auto decode_value(const uint8_t* data, uint8_t length) -> uint32_t {
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < length; ++i)
+            value |= uint32_t(data[i]) << (8 * i);
+        return value;
+    }
+
+    auto decode_groups_scalar(const uint8_t* control, const uint8_t* data, size_t groups, uint32_t* out)
+        -> const uint8_t* {
+        for (size_t group = 0; group < groups; ++group) {
+            uint8_t bits = control[group];
+            for (size_t i = 0; i < 4; ++i) {
+                uint8_t length = ((bits >> (2 * i)) & 3) + 1;
+                out[4 * group + i] = decode_value(data, length);
+                data += length;
+            }
+        }
+        return data;
+    }
+
+#ifdef JORMUNGANDR_STREAMVBYTE_SSSE3
+    constexpr auto make_shuffles() {
+        // For every control byte, the source byte of every output byte, or -1 to zero it
+        auto shuffles = std::array<std::array<int8_t, 16>, 256>();
+        for (size_t control = 0; control < 256; ++control) {
+            int8_t source = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                size_t length = ((control >> (2 * i)) & 3) + 1;
+                for (size_t byte = 0; byte < 4; ++byte)
+                    shuffles[control][4 * i + byte] = byte < length ? source++ : -1;
+            }
+        }
+        return shuffles;
+    }
+
+    alignas(16) constexpr auto shuffles = make_shuffles();
+
+    __attribute__((target("ssse3")))
+    auto decode_groups_ssse3(const uint8_t* control, const uint8_t* data, size_t groups, uint32_t* out)
+        -> const uint8_t* {
+        for (size_t group = 0; group < groups; ++group) {
+            uint8_t bits = control[group];
+            auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            auto shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles[bits].data()));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * group), _mm_shuffle_epi8(input, shuffle));
+            data += lengths[bits];
+        }
+        return data;
+    }
+
+    auto has_ssse3() -> bool {
+#ifdef __SSSE3__
+        return true;
+#else
+        static const bool supported = __builtin_cpu_supports("ssse3");
+        return supported;
+#endif
+    }
+#endif
+}
+
+auto streamvbyte_encode(std::span<const uint32_t> values, std::vector<uint8_t>& control, std::vector<uint8_t>& data) -> void {
+    for (size_t group = 0; group < values.size(); group += 4) {
+        uint8_t bits = 0;
+        for (size_t i = 0; i < 4 && group + i < values.size(); ++i) {
+            uint32_t value = values[group + i];
+            uint8_t length = value_length(value);
+            bits |= (length - 1) << (2 * i);
+            for (uint8_t byte = 0; byte < length; ++byte)
+                data.push_back(value >> (8 * byte));
+        }
+        control.push_back(bits);
+    }
+}
+
+auto streamvbyte_decode(const uint8_t* control, const uint8_t* data, size_t count, uint32_t* out) -> const uint8_t* {
+    size_t groups = count / 4;
+
+#ifdef JORMUNGANDR_STREAMVBYTE_SSSE3
+    if (has_ssse3())
+        data = decode_groups_ssse3(control, data, groups, out);
+    else
+        data = decode_groups_scalar(control, data, groups, out);
+#else
+    data = decode_groups_scalar(control, data, groups, out);
+#endif
+
+    // Last incomplete group
+    for (size_t i = 0; i < count % 4; ++i) {
+        uint8_t length = ((control[groups] >> (2 * i)) & 3) + 1;
+        out[4 * groups + i] = decode_value(data, length);
+        data += length;
+    }
+
+    return data;
+}
+
+auto streamvbyte_data_bytes(const uint8_t* control, size_t count) -> size_t {
+    size_t bytes = 0;
+    for (size_t group = 0; group < count / 4; ++group)
+        bytes += lengths[control[group]];
+    for (size_t i = 0; i < count % 4; ++i)
+        bytes += ((control[count / 4] >> (2 * i)) & 3) + 1;
+    return bytes;
+}